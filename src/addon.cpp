@@ -22,6 +22,7 @@
 
 #include "api/Joystick.h"
 #include "api/JoystickManager.h"
+#include "api/PeripheralEventPool.h"
 #include "api/PeripheralScanner.h"
 #include "filesystem/Filesystem.h"
 #include "log/Log.h"
@@ -89,8 +90,11 @@ ADDON_STATUS ADDON_Create(void* callbacks, void* props)
 
 void ADDON_Destroy()
 {
-  CStorageManager::Get().Deinitialize();
+  // Stop the joystick manager's threads first, they load device
+  // configurations from storage when joysticks are opened
   CJoystickManager::Get().Deinitialize();
+  CStorageManager::Get().Deinitialize();
+  CPeripheralEventPool::Get().Deinitialize();
   CFilesystem::Deinitialize();
 
   CLog::Get().SetType(SYS_LOG_TYPE_CONSOLE);
@@ -164,11 +168,12 @@ PERIPHERAL_ERROR GetEvents(unsigned int* event_count, PERIPHERAL_EVENT** events)
 
   PERIPHERAL_ERROR result = PERIPHERAL_ERROR_FAILED;
 
-  std::vector<ADDON::PeripheralEvent> peripheralEvents;
+  // Reuse storage from previous calls to avoid allocating on every frame
+  std::vector<ADDON::PeripheralEvent>& peripheralEvents = CPeripheralEventPool::Get().GetEventVector();
   if (CJoystickManager::Get().GetEvents(peripheralEvents))
   {
     *event_count = peripheralEvents.size();
-    ADDON::PeripheralEvents::ToStructs(peripheralEvents, events);
+    *events = CPeripheralEventPool::Get().Acquire(peripheralEvents);
     result = PERIPHERAL_NO_ERROR;
   }
 
@@ -179,7 +184,7 @@ PERIPHERAL_ERROR GetEvents(unsigned int* event_count, PERIPHERAL_EVENT** events)
 
 void FreeEvents(unsigned int event_count, PERIPHERAL_EVENT* events)
 {
-  ADDON::PeripheralEvents::FreeStructs(event_count, events);
+  CPeripheralEventPool::Get().Release(event_count, events);
 }
 
 bool SendEvent(const PERIPHERAL_EVENT* event)
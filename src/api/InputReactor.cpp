@@ -0,0 +1,224 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ */
+
+#include "InputReactor.h"
+#include "Joystick.h"
+#include "log/Log.h"
+
+#if defined(HAVE_EPOLL)
+  #include <errno.h>
+  #include <string.h>
+  #include <unistd.h>
+#endif
+
+using namespace JOYSTICK;
+
+#ifndef INVALID_FD
+  #define INVALID_FD  (-1)
+#endif
+
+// Maximum number of ready descriptors reported by one call to epoll_wait().
+// Level-triggered descriptors beyond this are reported by the next call.
+#define MAX_READY_EVENTS  32
+
+CInputReactor::CInputReactor(void)
+  : m_epollFd(INVALID_FD),
+#if defined(HAVE_EPOLL)
+    m_readyEventCount(0),
+#endif
+    m_pollCount(0),
+    m_readyCount(0),
+    m_skippedCount(0)
+{
+}
+
+bool CInputReactor::Initialize(void)
+{
+#if defined(HAVE_EPOLL)
+  if (m_epollFd < 0)
+  {
+    m_epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (m_epollFd < 0)
+    {
+      esyslog("Failed to create input reactor: %s", strerror(errno));
+      return false;
+    }
+
+    m_readyEvents.resize(MAX_READY_EVENTS);
+    m_readyEventCount = 0;
+  }
+
+  return true;
+#else
+  return false;
+#endif
+}
+
+void CInputReactor::Deinitialize(void)
+{
+  for (auto& watched : m_watched)
+    watched.second->SetWatched(false);
+  m_watched.clear();
+
+#if defined(HAVE_EPOLL)
+  if (m_epollFd >= 0)
+  {
+    LogStatistics();
+
+    close(m_epollFd);
+    m_epollFd = INVALID_FD;
+  }
+#endif
+}
+
+bool CInputReactor::Register(CJoystick* joystick)
+{
+#if defined(HAVE_EPOLL)
+  const int fd = joystick->InputDescriptor();
+  if (m_epollFd < 0 || fd < 0)
+    return false;
+
+  epoll_event event = { };
+  event.events = EPOLLIN;
+  event.data.fd = fd;
+
+  if (epoll_ctl(m_epollFd, EPOLL_CTL_ADD, fd, &event) < 0)
+  {
+    esyslog("Failed to watch joystick \"%s\": %s", joystick->Name().c_str(), strerror(errno));
+    return false;
+  }
+
+  m_watched[fd] = joystick;
+
+  joystick->SetWatched(true);
+
+  return true;
+#else
+  return false;
+#endif
+}
+
+void CInputReactor::Unregister(CJoystick* joystick)
+{
+  if (!joystick->IsWatched())
+    return;
+
+  const int fd = joystick->InputDescriptor();
+
+  auto it = m_watched.find(fd);
+  if (it != m_watched.end() && it->second == joystick)
+  {
+#if defined(HAVE_EPOLL)
+    // Descriptor is removed automatically if it has already been closed
+    if (m_epollFd >= 0)
+      epoll_ctl(m_epollFd, EPOLL_CTL_DEL, fd, nullptr);
+#endif
+    m_watched.erase(it);
+  }
+
+  joystick->SetWatched(false);
+}
+
+unsigned int CInputReactor::Poll(void)
+{
+  if (m_watched.empty())
+    return 0;
+
+  Wait(0);
+
+  return Dispatch();
+}
+
+unsigned int CInputReactor::Wait(int timeoutMs)
+{
+#if defined(HAVE_EPOLL)
+  m_readyEventCount = 0;
+
+  if (m_epollFd < 0)
+    return 0;
+
+  const int count = epoll_wait(m_epollFd, m_readyEvents.data(), static_cast<int>(m_readyEvents.size()), timeoutMs);
+  if (count < 0)
+  {
+    if (errno != EINTR)
+      esyslog("Failed to poll joysticks: %s", strerror(errno));
+    return 0;
+  }
+
+  m_readyEventCount = static_cast<unsigned int>(count);
+
+  return m_readyEventCount;
+#else
+  return 0;
+#endif
+}
+
+unsigned int CInputReactor::Dispatch(void)
+{
+  unsigned int readyCount = 0;
+
+#if defined(HAVE_EPOLL)
+  for (unsigned int i = 0; i < m_readyEventCount; i++)
+  {
+    auto it = m_watched.find(m_readyEvents[i].data.fd);
+    if (it == m_watched.end())
+      continue;
+
+    CJoystick* joystick = it->second;
+
+    // A hung-up descriptor stays ready forever, so stop watching it as soon
+    // as the device is gone
+    if (m_readyEvents[i].events & (EPOLLHUP | EPOLLERR))
+    {
+      Unregister(joystick);
+      joystick->SetDisconnected();
+      continue;
+    }
+
+    joystick->SetInputPending();
+    readyCount++;
+  }
+
+  m_readyEventCount = 0;
+
+  m_pollCount++;
+  m_readyCount += readyCount;
+  m_skippedCount += m_watched.size() - readyCount;
+#endif
+
+  return readyCount;
+}
+
+int64_t CInputReactor::SyscallsSaved(void) const
+{
+  // Each poll costs one epoll_wait()
+  return static_cast<int64_t>(m_skippedCount) - static_cast<int64_t>(m_pollCount);
+}
+
+void CInputReactor::LogStatistics(void) const
+{
+  if (m_pollCount == 0)
+    return;
+
+  dsyslog("Input reactor: %llu polls, %llu ready devices, %llu reads skipped, %lld syscalls saved",
+          static_cast<unsigned long long>(m_pollCount),
+          static_cast<unsigned long long>(m_readyCount),
+          static_cast<unsigned long long>(m_skippedCount),
+          static_cast<long long>(SyscallsSaved()));
+}
@@ -0,0 +1,123 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <map>
+#include <stdint.h>
+#include <vector>
+
+#if defined(HAVE_EPOLL)
+  #include <sys/epoll.h>
+#endif
+
+namespace JOYSTICK
+{
+  class CJoystick;
+
+  /*!
+   * \brief Readiness notification for joysticks backed by a file descriptor
+   *
+   * Joysticks that expose a descriptor through CJoystick::InputDescriptor()
+   * are added to a single epoll set. Poll() flags the joysticks that have
+   * input pending, so that CJoystick::GetEvents() only issues read() syscalls
+   * for devices that are actually readable.
+   *
+   * On platforms without epoll, registration fails and joysticks fall back to
+   * being polled on every call to GetEvents().
+   *
+   * Registration and Dispatch() must be serialized by the caller. Wait() may
+   * block on another thread, as long as only one thread waits at a time.
+   */
+  class CInputReactor
+  {
+  public:
+    CInputReactor(void);
+    ~CInputReactor(void) { Deinitialize(); }
+
+    bool Initialize(void);
+    void Deinitialize(void);
+    bool IsInitialized(void) const { return m_epollFd >= 0; }
+
+    /*!
+     * \brief Watch the joystick's input descriptor
+     *
+     * \return true if the joystick is watched, false if it must be polled
+     */
+    bool Register(CJoystick* joystick);
+
+    /*!
+     * \brief Stop watching the joystick's input descriptor
+     */
+    void Unregister(CJoystick* joystick);
+
+    /*!
+     * \brief Check for input and flag the joysticks that are readable
+     *
+     * Equivalent to Wait(0) followed by Dispatch().
+     *
+     * \return The number of joysticks with pending input
+     */
+    unsigned int Poll(void);
+
+    /*!
+     * \brief Wait for any watched descriptor to become readable
+     *
+     * \param timeoutMs Time to wait for input, or 0 to return immediately
+     *
+     * \return The number of readable descriptors
+     */
+    unsigned int Wait(int timeoutMs);
+
+    /*!
+     * \brief Flag the joysticks whose descriptors were found readable by the
+     *        last call to Wait()
+     *
+     * Descriptors are matched against the currently registered joysticks, so
+     * joysticks unregistered while waiting are never touched. Joysticks whose
+     * descriptors hang up are unregistered and marked as disconnected.
+     *
+     * \return The number of joysticks with pending input
+     */
+    unsigned int Dispatch(void);
+
+    /*!
+     * \brief Number of read() syscalls avoided, less the cost of polling
+     */
+    int64_t SyscallsSaved(void) const;
+
+    /*!
+     * \brief Log polling statistics
+     */
+    void LogStatistics(void) const;
+
+  private:
+    int                       m_epollFd;
+    std::map<int, CJoystick*> m_watched; // Input descriptor -> joystick
+
+#if defined(HAVE_EPOLL)
+    std::vector<epoll_event> m_readyEvents;
+    unsigned int             m_readyEventCount;
+#endif
+
+    // Statistics
+    uint64_t m_pollCount;
+    uint64_t m_readyCount;
+    uint64_t m_skippedCount;
+  };
+}
@@ -0,0 +1,59 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ */
+
+#include "InputThread.h"
+#include "InputReactor.h"
+#include "JoystickManager.h"
+#include "JoystickTypes.h"
+
+using namespace JOYSTICK;
+
+CInputThread::CInputThread(CJoystickManager& manager, CInputReactor& reactor)
+  : m_manager(manager),
+    m_reactor(reactor)
+{
+}
+
+bool CInputThread::Start(void)
+{
+  if (IsRunning())
+    return true;
+
+  return CreateThread();
+}
+
+void CInputThread::Stop(void)
+{
+  // Wait for the current iteration to finish
+  StopThread(0);
+}
+
+void* CInputThread::Process(void)
+{
+  while (!IsStopped())
+  {
+    m_reactor.Wait(THREAD_STOP_TIMEOUT_MS);
+
+    // Joysticks without pending input return immediately unless an axis
+    // keep-alive is due
+    m_manager.QueueEvents();
+  }
+
+  return nullptr;
+}
@@ -0,0 +1,54 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "p8-platform/threads/threads.h"
+
+namespace JOYSTICK
+{
+  class CInputReactor;
+  class CJoystickManager;
+
+  /*!
+   * \brief Background thread that drains watched joysticks as soon as their
+   *        input descriptors become readable
+   *
+   * Events are queued per joystick by CJoystick::QueueEvents() and collected
+   * by the frontend with CJoystick::DequeueEvents(). This decouples kernel
+   * reads from the frontend's frame rate, so that small driver queues (such as
+   * the 64 events of the Linux Joystick API) don't overflow when a frame stalls.
+   */
+  class CInputThread : protected P8PLATFORM::CThread
+  {
+  public:
+    CInputThread(CJoystickManager& manager, CInputReactor& reactor);
+    virtual ~CInputThread(void) { Stop(); }
+
+    bool Start(void);
+    void Stop(void);
+
+  protected:
+    // implementation of CThread
+    virtual void* Process(void) override;
+
+  private:
+    CJoystickManager& m_manager;
+    CInputReactor&    m_reactor;
+  };
+}
@@ -24,20 +24,42 @@
 #include "JoystickUtils.h"
 #include "log/Log.h"
 #include "settings/Settings.h"
+#include "storage/DeviceConfiguration.h"
+#include "storage/StorageManager.h"
 #include "utils/CommonMacros.h"
 #include "utils/StringUtils.h"
 
 #include "p8-platform/util/timeutils.h"
 
+#include <algorithm>
+#include <cmath>
+
 using namespace JOYSTICK;
 
+// Default change in an axis's value that produces an event
 #define ANALOG_EPSILON  0.0001f
 
+// Events buffered between the input thread and GetEvents()
+#define EVENT_QUEUE_SIZE  1024
+
+// Transitions recorded per scan when ordered events are enabled. If the log
+// fills up, the remaining transitions are coalesced into the latest state.
+#define EVENT_LOG_SIZE  256
+
 CJoystick::CJoystick(EJoystickInterface interfaceType)
- : m_discoverTimeMs(P8PLATFORM::GetTimeMs()),
+ : m_inputTimeUs(0),
+   m_lastKeepAliveMs(-1),
+   m_droppedEventCount(0),
+   m_droppedTransitionCount(0),
+   m_discoverTimeMs(P8PLATFORM::GetTimeMs()),
    m_activateTimeMs(-1),
    m_firstEventTimeMs(-1),
-   m_lastEventTimeMs(-1)
+   m_lastEventTimeMs(-1),
+   m_bWatched(false),
+   m_bInputPending(false),
+   m_bLogTransitions(false),
+   m_bSeedingState(false),
+   m_bDisconnected(false)
 {
   SetProvider(JoystickTranslator::GetInterfaceProvider(interfaceType));
 }
@@ -56,6 +78,20 @@ bool CJoystick::Equals(const CJoystick* rhs) const
          AxisCount()     == rhs->AxisCount();
 }
 
+std::string CJoystick::Identity(void) const
+{
+  return StringUtils::Format("%d/%s/%s/%04x/%04x/%u/%u/%u/%u",
+                             static_cast<int>(Type()),
+                             Provider().c_str(),
+                             Name().c_str(),
+                             VendorID(),
+                             ProductID(),
+                             RequestedPort(),
+                             ButtonCount(),
+                             HatCount(),
+                             AxisCount());
+}
+
 void CJoystick::SetName(const std::string& strName)
 {
   std::string strSanitizedFilename = StringUtils::MakeSafeString(strName);
@@ -74,32 +110,107 @@ bool CJoystick::Initialize(void)
     return false;
   }
 
-  m_state.buttons.assign(ButtonCount(), JOYSTICK_STATE_BUTTON_UNPRESSED);
-  m_state.hats.assign(HatCount(), JOYSTICK_STATE_HAT_UNPRESSED);
-  m_state.axes.resize(AxisCount());
+  m_state.Reset(ButtonCount(), HatCount(), AxisCount());
+  m_stateBuffer.Reset(ButtonCount(), HatCount(), AxisCount());
+
+  m_dirty.hats.Resize(HatCount());
+  m_dirty.axes.Resize(AxisCount());
+
+  m_rawAxes.Assign(AxisCount(), 0.0f);
+  m_calibration.Assign(AxisCount(), AxisCalibration());
+  m_ignored.buttons.Resize(ButtonCount());
+  m_ignored.axes.Resize(AxisCount());
+  if (!LoadConfiguration())
+    dsyslog("Joystick \"%s\": no stored configuration, sending uncalibrated axes", Name().c_str());
+
+  m_inputTimes.buttons.Assign(ButtonCount(), 0);
+  m_inputTimes.hats.Assign(HatCount(), 0);
+  m_inputTimes.axes.Assign(AxisCount(), 0);
+
+  // Start from the device's actual state, so that held buttons and axes
+  // resting away from the center don't produce events on the first poll.
+  // The seeded elements have no input time, as they have nothing to send.
+  m_inputTimeUs = 0;
+  m_bSeedingState = true;
+  SeedState();
+  m_bSeedingState = false;
+
+  m_state = m_stateBuffer;
+
+  m_dirty.hats.ResetAll();
+  m_dirty.axes.ResetAll();
 
-  m_stateBuffer.buttons.assign(ButtonCount(), JOYSTICK_STATE_BUTTON_UNPRESSED);
-  m_stateBuffer.hats.assign(HatCount(), JOYSTICK_STATE_HAT_UNPRESSED);
-  m_stateBuffer.axes.resize(AxisCount());
+  m_eventQueue.Reset(EVENT_QUEUE_SIZE);
+
+  m_eventLog.clear();
+  m_eventLog.reserve(EVENT_LOG_SIZE);
 
   return true;
 }
 
 void CJoystick::Deinitialize(void)
 {
-  m_state.buttons.clear();
-  m_state.hats.clear();
-  m_state.axes.clear();
+  m_state.Reset(0, 0, 0);
+  m_stateBuffer.Reset(0, 0, 0);
+
+  m_dirty.hats.Resize(0);
+  m_dirty.axes.Resize(0);
+
+  m_rawAxes.Clear();
+  m_calibration.Clear();
+  m_ignored.buttons.Resize(0);
+  m_ignored.axes.Resize(0);
 
-  m_stateBuffer.buttons.clear();
-  m_stateBuffer.hats.clear();
-  m_stateBuffer.axes.clear();
+  m_inputTimes.buttons.Clear();
+  m_inputTimes.hats.Clear();
+  m_inputTimes.axes.Clear();
+
+  m_eventLog.clear();
 }
 
 bool CJoystick::GetEvents(std::vector<ADDON::PeripheralEvent>& events)
 {
-  if (ScanEvents())
+  m_eventTimes.clear();
+
+  if (!ReadEvents(events))
+    return false;
+
+  if (!m_eventTimes.empty())
+  {
+    const int64_t nowUs = CJoystickUtils::GetMonotonicTimeUs();
+    for (int64_t timestampUs : m_eventTimes)
+    {
+      if (timestampUs > 0)
+        m_latency.Add(nowUs - timestampUs);
+    }
+  }
+
+  return true;
+}
+
+bool CJoystick::ReadEvents(std::vector<ADDON::PeripheralEvent>& events)
+{
+  if (m_bDisconnected)
+    return false;
+
+  bool bScanned = true;
+
+  // Skip the kernel if the input reactor saw nothing to read
+  if (!m_bWatched || m_bInputPending)
+  {
+    m_bInputPending = false;
+    m_inputTimeUs = CJoystickUtils::GetMonotonicTimeUs();
+    m_bLogTransitions = CSettings::Get().UseOrderedEvents();
+    bScanned = ScanEvents();
+    m_bLogTransitions = false;
+  }
+
+  if (bScanned)
   {
+    // Logged transitions update m_state as they are emitted, so the diffs
+    // below only report changes that didn't fit in the log
+    GetLoggedEvents(events);
+
     GetButtonEvents(events);
     GetHatEvents(events);
     GetAxisEvents(events);
@@ -112,6 +223,61 @@ bool CJoystick::GetEvents(std::vector<ADDON::PeripheralEvent>& events)
   return false;
 }
 
+void CJoystick::QueueEvents(void)
+{
+  // Nothing new since the last call
+  if (m_bWatched && !m_bInputPending && !IsAxisKeepAliveDue(P8PLATFORM::GetTimeMs()))
+    return;
+
+  m_queueScratch.clear();
+  m_eventTimes.clear();
+  ReadEvents(m_queueScratch);
+
+  for (unsigned int i = 0; i < m_queueScratch.size(); i++)
+  {
+    TimedEvent queuedEvent;
+    queuedEvent.event = m_queueScratch[i];
+    queuedEvent.timestampUs = m_eventTimes[i];
+
+    if (!m_eventQueue.Push(queuedEvent))
+    {
+      if (m_droppedEventCount++ == 0)
+        esyslog("Event queue for joystick \"%s\" is full, dropping events", Name().c_str());
+    }
+  }
+}
+
+void CJoystick::DequeueEvents(std::vector<ADDON::PeripheralEvent>& events)
+{
+  int64_t nowUs = -1;
+
+  TimedEvent queuedEvent;
+  while (m_eventQueue.Pop(queuedEvent))
+  {
+    events.push_back(queuedEvent.event);
+
+    if (queuedEvent.timestampUs > 0)
+    {
+      if (nowUs < 0)
+        nowUs = CJoystickUtils::GetMonotonicTimeUs();
+      m_latency.Add(nowUs - queuedEvent.timestampUs);
+    }
+  }
+}
+
+void CJoystick::LogLatencyStatistics(void) const
+{
+  if (m_latency.Count() == 0)
+    return;
+
+  dsyslog("Joystick %u \"%s\": %llu timestamped events, latency p50 %lld us, p99 %lld us, max %lld us",
+          Index(), Name().c_str(),
+          static_cast<unsigned long long>(m_latency.Count()),
+          static_cast<long long>(m_latency.PercentileUs(0.5f)),
+          static_cast<long long>(m_latency.PercentileUs(0.99f)),
+          static_cast<long long>(m_latency.MaxUs()));
+}
+
 bool CJoystick::SendEvent(const ADDON::PeripheralEvent& event)
 {
   bool bHandled = false;
@@ -130,8 +296,23 @@ bool CJoystick::SendEvent(const ADDON::PeripheralEvent& event)
   return bHandled;
 }
 
+void CJoystick::SetDisconnected(void)
+{
+  if (!m_bDisconnected.exchange(true))
+  {
+    isyslog("Joystick %u \"%s\" disconnected", Index(), Name().c_str());
+
+    CJoystickManager::Get().SetChanged(true);
+    CJoystickManager::Get().TriggerScan();
+  }
+}
+
 void CJoystick::Activate()
 {
+  // The initial state isn't input from the user
+  if (m_bSeedingState)
+    return;
+
   if (!IsActive())
   {
     m_activateTimeMs = P8PLATFORM::GetTimeMs();
@@ -144,74 +325,272 @@ void CJoystick::Activate()
   }
 }
 
-void CJoystick::GetButtonEvents(std::vector<ADDON::PeripheralEvent>& events)
+void CJoystick::GetLoggedEvents(std::vector<ADDON::PeripheralEvent>& events)
 {
-  const std::vector<JOYSTICK_STATE_BUTTON>& buttons = m_stateBuffer.buttons;
+  for (const TimedEvent& transition : m_eventLog)
+  {
+    const ADDON::PeripheralEvent& event = transition.event;
+    const unsigned int index = event.DriverIndex();
+
+    bool bEmit = false;
+
+    switch (event.Type())
+    {
+      case PERIPHERAL_EVENT_TYPE_DRIVER_BUTTON:
+      {
+        const bool bPressed = (event.ButtonState() == JOYSTICK_STATE_BUTTON_PRESSED);
+        if (index < m_state.buttons.Size() && m_state.buttons.Test(index) != bPressed)
+        {
+          m_state.buttons.Set(index, bPressed);
+          m_inputTimes.buttons[index] = 0;
+          bEmit = true;
+        }
+        break;
+      }
+      case PERIPHERAL_EVENT_TYPE_DRIVER_HAT:
+      {
+        if (index < m_state.hats.Size() && m_state.hats[index] != event.HatState())
+        {
+          m_state.hats[index] = event.HatState();
+          m_inputTimes.hats[index] = 0;
+          bEmit = true;
+        }
+        break;
+      }
+      case PERIPHERAL_EVENT_TYPE_DRIVER_AXIS:
+      {
+        if (index < m_state.axes.Size())
+        {
+          const float sentState = m_state.axes[index];
+          const float state = event.AxisState();
+
+          if (!m_state.axesSeen.Test(index) ||
+              std::abs(state - sentState) > GetAxisThreshold(index) ||
+              (state == 0.0f && sentState != 0.0f))
+          {
+            m_state.axes[index] = state;
+            m_state.axesSeen.Set(index);
+            m_inputTimes.axes[index] = 0;
+            bEmit = true;
+          }
+        }
+        break;
+      }
+      default:
+        break;
+    }
+
+    if (bEmit)
+    {
+      events.push_back(event);
+      m_eventTimes.push_back(transition.timestampUs);
+    }
+  }
+
+  m_eventLog.clear();
+}
 
-  for (unsigned int i = 0; i < buttons.size(); i++)
+void CJoystick::LogTransition(const ADDON::PeripheralEvent& event)
+{
+  // Capacity is reserved by Initialize(), so this never allocates
+  if (m_eventLog.size() < m_eventLog.capacity())
+  {
+    TimedEvent transition;
+    transition.event = event;
+    transition.timestampUs = m_inputTimeUs;
+    m_eventLog.push_back(transition);
+  }
+  else if (m_droppedTransitionCount++ == 0)
   {
-    if (buttons[i] != m_state.buttons[i])
-      events.push_back(ADDON::PeripheralEvent(Index(), i, buttons[i]));
+    dsyslog("Transition log for joystick \"%s\" is full, coalescing events", Name().c_str());
   }
+}
 
-  m_state.buttons.assign(buttons.begin(), buttons.end());
+void CJoystick::JoystickState::Reset(unsigned int buttonCount, unsigned int hatCount, unsigned int axisCount)
+{
+  buttons.Resize(buttonCount);
+  hats.Assign(hatCount, JOYSTICK_STATE_HAT_UNPRESSED);
+  axes.Assign(axisCount, 0.0f);
+  axesSeen.Resize(axisCount);
 }
 
-void CJoystick::GetHatEvents(std::vector<ADDON::PeripheralEvent>& events)
+void CJoystick::GetButtonEvents(std::vector<ADDON::PeripheralEvent>& events)
 {
-  const std::vector<JOYSTICK_STATE_HAT>& hats = m_stateBuffer.hats;
+  // Buttons are compared 64 at a time, and only those that changed are visited
+  m_stateBuffer.buttons.ForEachDifference(m_state.buttons, [this, &events](size_t i)
+  {
+    const bool bPressed = m_stateBuffer.buttons.Test(i);
 
-  for (unsigned int i = 0; i < hats.size(); i++)
+    events.push_back(ADDON::PeripheralEvent(Index(), static_cast<unsigned int>(i),
+        bPressed ? JOYSTICK_STATE_BUTTON_PRESSED : JOYSTICK_STATE_BUTTON_UNPRESSED));
+    m_eventTimes.push_back(m_inputTimes.buttons[i]);
+    m_inputTimes.buttons[i] = 0;
+
+    m_state.buttons.Set(i, bPressed);
+  });
+}
+
+void CJoystick::GetHatEvents(std::vector<ADDON::PeripheralEvent>& events)
+{
+  // Only hats set since the last poll can differ from the sent state
+  m_dirty.hats.ForEach([this, &events](size_t i)
   {
-    if (hats[i] != m_state.hats[i])
-      events.push_back(ADDON::PeripheralEvent(Index(), i, hats[i]));
-  }
+    const JOYSTICK_STATE_HAT hat = m_stateBuffer.hats[i];
+    if (hat != m_state.hats[i])
+    {
+      events.push_back(ADDON::PeripheralEvent(Index(), static_cast<unsigned int>(i), hat));
+      m_eventTimes.push_back(m_inputTimes.hats[i]);
+      m_inputTimes.hats[i] = 0;
+
+      m_state.hats[i] = hat;
+    }
+  });
 
-  m_state.hats.assign(hats.begin(), hats.end());
+  m_dirty.hats.ResetAll();
 }
 
 void CJoystick::GetAxisEvents(std::vector<ADDON::PeripheralEvent>& events)
 {
-  const std::vector<JoystickAxis>& axes = m_stateBuffer.axes;
+  // Periodically resend every axis for frontends that expect a steady stream
+  const int64_t nowMs = P8PLATFORM::GetTimeMs();
+  const bool bKeepAlive = IsAxisKeepAliveDue(nowMs);
+  if (bKeepAlive)
+  {
+    m_lastKeepAliveMs = nowMs;
 
-  for (unsigned int i = 0; i < axes.size(); i++)
+    for (unsigned int i = 0; i < m_stateBuffer.axes.Size(); i++)
+      GetAxisEvent(i, true, events);
+  }
+  else
   {
-    if (axes[i].bSeen)
-      events.push_back(ADDON::PeripheralEvent(Index(), i, axes[i].state));
+    // Only axes set since the last poll can differ from the sent state
+    m_dirty.axes.ForEach([this, &events](size_t i)
+    {
+      GetAxisEvent(static_cast<unsigned int>(i), false, events);
+    });
   }
 
-  m_state.axes.assign(axes.begin(), axes.end());
+  m_dirty.axes.ResetAll();
+}
+
+void CJoystick::GetAxisEvent(unsigned int axisIndex, bool bKeepAlive, std::vector<ADDON::PeripheralEvent>& events)
+{
+  if (!m_stateBuffer.axesSeen.Test(axisIndex))
+    return;
+
+  const float state = m_stateBuffer.axes[axisIndex];
+
+  // m_state holds the last value sent to the frontend
+  const float sentState = m_state.axes[axisIndex];
+
+  bool bChanged = !m_state.axesSeen.Test(axisIndex) ||
+                  std::abs(state - sentState) > GetAxisThreshold(axisIndex);
+
+  // Always deliver the rest position so that small movements back to the
+  // center aren't swallowed by the threshold
+  if (state == 0.0f && sentState != 0.0f)
+    bChanged = true;
+
+  if (bChanged || bKeepAlive)
+  {
+    events.push_back(ADDON::PeripheralEvent(Index(), axisIndex, state));
+    m_eventTimes.push_back(m_inputTimes.axes[axisIndex]);
+    m_inputTimes.axes[axisIndex] = 0;
+
+    m_state.axes[axisIndex] = state;
+    m_state.axesSeen.Set(axisIndex);
+  }
 }
 
 void CJoystick::SetButtonValue(unsigned int buttonIndex, JOYSTICK_STATE_BUTTON buttonValue)
 {
+  // Ignored buttons are dropped before they can activate the joystick
+  if (buttonIndex < m_ignored.buttons.Size() && m_ignored.buttons.Test(buttonIndex))
+    return;
+
   Activate();
 
-  if (buttonIndex < m_stateBuffer.buttons.size())
-    m_stateBuffer.buttons[buttonIndex] = buttonValue;
+  if (buttonIndex < m_stateBuffer.buttons.Size())
+  {
+    m_stateBuffer.buttons.Set(buttonIndex, buttonValue == JOYSTICK_STATE_BUTTON_PRESSED);
+    m_inputTimes.buttons[buttonIndex] = m_inputTimeUs;
+
+    if (m_bLogTransitions)
+      LogTransition(ADDON::PeripheralEvent(Index(), buttonIndex, buttonValue));
+  }
 }
 
 void CJoystick::SetHatValue(unsigned int hatIndex, JOYSTICK_STATE_HAT hatValue)
 {
   Activate();
 
-  if (hatIndex < m_stateBuffer.hats.size())
+  if (hatIndex < m_stateBuffer.hats.Size())
+  {
     m_stateBuffer.hats[hatIndex] = hatValue;
+    m_dirty.hats.Set(hatIndex);
+    m_inputTimes.hats[hatIndex] = m_inputTimeUs;
+
+    if (m_bLogTransitions)
+      LogTransition(ADDON::PeripheralEvent(Index(), hatIndex, hatValue));
+  }
 }
 
 void CJoystick::SetAxisValue(unsigned int axisIndex, JOYSTICK_STATE_AXIS axisValue)
 {
+  // Ignored axes, such as jittery accelerometers, are dropped before they can
+  // activate the joystick
+  if (axisIndex < m_ignored.axes.Size() && m_ignored.axes.Test(axisIndex))
+    return;
+
   Activate();
 
   axisValue = CONSTRAIN(-1.0f, axisValue, 1.0f);
 
-  if (axisIndex < m_stateBuffer.axes.size())
+  if (axisIndex < m_stateBuffer.axes.Size())
   {
-    m_stateBuffer.axes[axisIndex].state = axisValue;
-    m_stateBuffer.axes[axisIndex].bSeen = true;
+    const AxisCalibration& calibration = m_calibration[axisIndex];
+
+    // Map the trigger's calibrated range to [0.0, 1.0] or [-1.0, 0.0], so a
+    // trigger at rest reads 0 like any other axis
+    axisValue = CONSTRAIN(-1.0f, axisValue * calibration.scale + calibration.offset, 1.0f);
+
+    m_rawAxes[axisIndex] = axisValue;
+
+    // Noise around the center is removed here, before change detection, so
+    // that it never turns into events
+    if (calibration.stickAxis >= 0)
+    {
+      const unsigned int stickAxis = static_cast<unsigned int>(calibration.stickAxis);
+
+      float x = axisValue;
+      float y = m_rawAxes[stickAxis];
+      ScaleRadialDeadzone(calibration.deadzone, x, y);
+
+      SetProcessedAxisValue(axisIndex, x);
+
+      // The other axis is scaled by the same distance, so it changes too
+      if (m_stateBuffer.axesSeen.Test(stickAxis) && !m_ignored.axes.Test(stickAxis) &&
+          m_stateBuffer.axes[stickAxis] != y)
+        SetProcessedAxisValue(stickAxis, y);
+    }
+    else
+    {
+      SetProcessedAxisValue(axisIndex, ScaleDeadzone(axisValue, calibration.deadzone));
+    }
   }
 }
 
+void CJoystick::SetProcessedAxisValue(unsigned int axisIndex, JOYSTICK_STATE_AXIS axisValue)
+{
+  m_stateBuffer.axes[axisIndex] = axisValue;
+  m_stateBuffer.axesSeen.Set(axisIndex);
+  m_dirty.axes.Set(axisIndex);
+  m_inputTimes.axes[axisIndex] = m_inputTimeUs;
+
+  if (m_bLogTransitions)
+    LogTransition(ADDON::PeripheralEvent(Index(), axisIndex, axisValue));
+}
+
 void CJoystick::SetAxisValue(unsigned int axisIndex, long value, long maxAxisAmount)
 {
   if (maxAxisAmount != 0)
@@ -227,7 +606,148 @@ void CJoystick::UpdateTimers(void)
   m_lastEventTimeMs = P8PLATFORM::GetTimeMs();
 }
 
+unsigned int CJoystick::ReadBudget(void) const
+{
+  return CSettings::Get().ReadBudget();
+}
+
+float CJoystick::GetAxisThreshold(unsigned int axisIndex) const
+{
+  if (axisIndex < m_calibration.Size() && m_calibration[axisIndex].threshold > 0.0f)
+    return m_calibration[axisIndex].threshold;
+
+  const float threshold = CSettings::Get().AxisThreshold();
+  return threshold > 0.0f ? threshold : ANALOG_EPSILON;
+}
+
+bool CJoystick::IsAxisKeepAliveDue(int64_t nowMs) const
+{
+  const unsigned int keepAliveMs = CSettings::Get().AxisKeepAliveMs();
+  if (keepAliveMs == 0)
+    return false;
+
+  return m_lastKeepAliveMs < 0 || nowMs - m_lastKeepAliveMs >= keepAliveMs;
+}
+
 float CJoystick::NormalizeAxis(long value, long maxAxisAmount)
 {
   return 1.0f * CONSTRAIN(-maxAxisAmount, value, maxAxisAmount) / maxAxisAmount;
 }
+
+float CJoystick::ScaleDeadzone(float value, float deadzone)
+{
+  if (deadzone <= 0.0f)
+    return value;
+
+  const float magnitude = std::abs(value);
+  if (magnitude <= deadzone)
+    return 0.0f;
+
+  const float scaled = (magnitude - deadzone) / (1.0f - deadzone);
+
+  return value < 0.0f ? -scaled : scaled;
+}
+
+void CJoystick::ScaleRadialDeadzone(float deadzone, float& x, float& y)
+{
+  if (deadzone <= 0.0f)
+    return;
+
+  const float magnitude = std::sqrt(x * x + y * y);
+  if (magnitude <= deadzone)
+  {
+    x = 0.0f;
+    y = 0.0f;
+    return;
+  }
+
+  // Diagonals can exceed a distance of 1, so clamp each axis afterwards
+  const float scale = ScaleDeadzone(magnitude, deadzone) / magnitude;
+  x = CONSTRAIN(-1.0f, x * scale, 1.0f);
+  y = CONSTRAIN(-1.0f, y * scale, 1.0f);
+}
+
+bool CJoystick::LoadConfiguration(void)
+{
+  // Devices are stored as the frontend reports them, without the index
+  // assigned by the add-on
+  ADDON::Joystick deviceInfo(*this);
+  deviceInfo.SetIndex(0);
+
+  CDeviceConfiguration configuration;
+  if (!CStorageManager::Get().GetDeviceConfiguration(deviceInfo, configuration))
+    return false;
+
+  SetConfiguration(configuration);
+
+  return true;
+}
+
+void CJoystick::SetConfiguration(const CDeviceConfiguration& configuration)
+{
+  // A deadzone of 1.0 or more would swallow the whole axis
+  const float MAX_DEADZONE = 0.99f;
+
+  m_calibration.Assign(m_calibration.Size(), AxisCalibration());
+  m_ignored.buttons.ResetAll();
+  m_ignored.axes.ResetAll();
+
+  for (const auto& buttonConfig : configuration.Buttons())
+  {
+    if (buttonConfig.first < m_ignored.buttons.Size() && buttonConfig.second.bIgnore)
+      m_ignored.buttons.Set(buttonConfig.first);
+  }
+
+  for (const auto& axisConfig : configuration.Axes())
+  {
+    const unsigned int axisIndex = axisConfig.first;
+    const DeadzoneProperties& properties = axisConfig.second.deadzone;
+
+    if (axisIndex >= m_calibration.Size())
+      continue;
+
+    if (axisConfig.second.bIgnore)
+      m_ignored.axes.Set(axisIndex);
+
+    AxisCalibration& calibration = m_calibration[axisIndex];
+
+    // Precompute the affine transform that maps the trigger's range, starting
+    // at its center, to a semiaxis starting at 0
+    const TriggerProperties& trigger = axisConfig.second.trigger;
+    if (trigger.range > 0)
+    {
+      calibration.trigger = trigger;
+      calibration.scale = 1.0f / trigger.range;
+      calibration.offset = -static_cast<float>(trigger.center) / trigger.range;
+    }
+
+    if (axisConfig.second.threshold > 0.0f)
+      calibration.threshold = axisConfig.second.threshold;
+
+    if (properties.deadzone <= 0.0f)
+      continue;
+
+    calibration.deadzone = std::max(calibration.deadzone, std::min(properties.deadzone, MAX_DEADZONE));
+
+    const int stickAxis = properties.stickAxis;
+    if (0 <= stickAxis && stickAxis < static_cast<int>(m_calibration.Size()) && stickAxis != static_cast<int>(axisIndex))
+    {
+      // Both axes of a stick share the larger of their deadzones
+      AxisCalibration& stickCalibration = m_calibration[stickAxis];
+      calibration.deadzone = std::max(calibration.deadzone, stickCalibration.deadzone);
+      stickCalibration.deadzone = calibration.deadzone;
+
+      calibration.stickAxis = stickAxis;
+      stickCalibration.stickAxis = static_cast<int>(axisIndex);
+    }
+  }
+}
+
+void CJoystick::GetAppliedTriggers(TriggerPropertiesMap& triggers) const
+{
+  for (unsigned int i = 0; i < m_calibration.Size(); i++)
+  {
+    if (!(m_calibration[i].trigger == TriggerProperties()))
+      triggers[i] = m_calibration[i].trigger;
+  }
+}
@@ -20,14 +20,22 @@
 #pragma once
 
 #include "JoystickTypes.h"
+#include "LatencyHistogram.h"
+#include "storage/PrimitiveConfiguration.h"
+#include "utils/Bitset.h"
+#include "utils/InlineVector.h"
+#include "utils/RingBuffer.h"
 
 #include "kodi_peripheral_utils.hpp"
 
+#include <atomic>
 #include <string>
 #include <vector>
 
 namespace JOYSTICK
 {
+  class CDeviceConfiguration;
+
   class CJoystick : public ADDON::Joystick
   {
   public:
@@ -40,6 +48,12 @@ namespace JOYSTICK
      */
     virtual bool Equals(const CJoystick* rhs) const;
 
+    /*!
+     * Key that identifies the underlying device among all joysticks. Two
+     * joysticks have the same key if and only if Equals() is true.
+     */
+    virtual std::string Identity(void) const;
+
     /*!
      * Override subclass to sanitize name (strip trailing whitespace, etc)
      */
@@ -60,6 +74,17 @@ namespace JOYSTICK
      */
     bool IsActive(void) const { return m_activateTimeMs >= 0; }
 
+    /*!
+     * Mark the joystick as unplugged. It is no longer read, and a scan is
+     * triggered to remove it.
+     */
+    void SetDisconnected(void);
+
+    /*!
+     * Check if the joystick has been unplugged
+     */
+    bool IsDisconnected(void) const { return m_bDisconnected; }
+
     /*!
      * The time that this joystick delivered its first event
      */
@@ -87,6 +112,17 @@ namespace JOYSTICK
      */
     virtual bool GetEvents(std::vector<ADDON::PeripheralEvent>& events);
 
+    /*!
+     * Called on the input thread to scan for events and queue them for the
+     * next call to DequeueEvents()
+     */
+    void QueueEvents(void);
+
+    /*!
+     * Get events that have been queued by the input thread
+     */
+    void DequeueEvents(std::vector<ADDON::PeripheralEvent>& events);
+
     /*!
      * Send an event to a joystick
      */
@@ -102,6 +138,44 @@ namespace JOYSTICK
      */
     virtual void PowerOff() { }
 
+    /*!
+     * File descriptor that becomes readable when input is pending, or -1 if
+     * the joystick must be scanned on every call to GetEvents()
+     */
+    virtual int InputDescriptor(void) const { return -1; }
+
+    /*!
+     * Set by the input reactor when the input descriptor is being watched
+     */
+    void SetWatched(bool bWatched) { m_bWatched = bWatched; }
+    bool IsWatched(void) const { return m_bWatched; }
+
+    /*!
+     * Set by the input reactor when the input descriptor is readable. Watched
+     * joysticks are only scanned when input is pending.
+     */
+    void SetInputPending(void) { m_bInputPending = true; }
+
+    /*!
+     * Log the distribution of delays between input being generated and its
+     * events being returned by GetEvents() or DequeueEvents()
+     */
+    void LogLatencyStatistics(void) const;
+
+    /*!
+     * Apply the device's stored configuration: trigger calibration, axis
+     * deadzones and event thresholds, and buttons and axes that are ignored.
+     * Ignored elements are dropped by the Set*Value() functions, so they
+     * never reach the state buffer.
+     */
+    void SetConfiguration(const CDeviceConfiguration& configuration);
+
+    /*!
+     * Get the trigger calibrations applied to axis values, by axis index.
+     * Axes that are sent uncalibrated are left out.
+     */
+    void GetAppliedTriggers(TriggerPropertiesMap& triggers) const;
+
   protected:
     /*!
      * Implemented by derived class to scan for events
@@ -110,44 +184,180 @@ namespace JOYSTICK
 
     virtual bool SetMotor(unsigned int motorIndex, float magnitude) { return false; }
 
+    /*!
+     * Implemented by derived class to report the device's current state
+     * through the Set*Value() functions. Called by Initialize(), and the
+     * values reported become the initial state without generating events.
+     */
+    virtual void SeedState(void) { }
+
+    /*!
+     * Set the time that the following input was generated, in microseconds on
+     * the clock of CJoystickUtils::GetMonotonicTimeUs(). Defaults to the time
+     * that ScanEvents() was called.
+     */
+    void SetInputTime(int64_t timestampUs) { m_inputTimeUs = timestampUs; }
+
+    /*!
+     * Maximum number of events that ScanEvents() should read per call, or 0
+     * for no limit. Events beyond the budget are left in the driver's queue
+     * and read by the next call, so a noisy device can't delay the others.
+     */
+    unsigned int ReadBudget(void) const;
+
     virtual void SetButtonValue(unsigned int buttonIndex, JOYSTICK_STATE_BUTTON buttonValue);
     virtual void SetHatValue(unsigned int hatIndex, JOYSTICK_STATE_HAT hatValue);
     virtual void SetAxisValue(unsigned int axisIndex, JOYSTICK_STATE_AXIS axisValue);
     void SetAxisValue(unsigned int axisIndex, long value, long maxAxisAmount);
 
   private:
+    bool ReadEvents(std::vector<ADDON::PeripheralEvent>& events);
+
+    /*!
+     * Emit the transitions recorded by ScanEvents() in the order that they
+     * occurred, including those that were overwritten before the poll
+     */
+    void GetLoggedEvents(std::vector<ADDON::PeripheralEvent>& events);
+    void LogTransition(const ADDON::PeripheralEvent& event);
+
     void Activate();
 
     void GetButtonEvents(std::vector<ADDON::PeripheralEvent>& events);
     void GetHatEvents(std::vector<ADDON::PeripheralEvent>& events);
     void GetAxisEvents(std::vector<ADDON::PeripheralEvent>& events);
+    void GetAxisEvent(unsigned int axisIndex, bool bKeepAlive, std::vector<ADDON::PeripheralEvent>& events);
 
     void UpdateTimers(void);
 
+    float GetAxisThreshold(unsigned int axisIndex) const;
+    bool IsAxisKeepAliveDue(int64_t nowMs) const;
+
     /*!
      * Normalize the axis to the closed interval [-1.0, 1.0].
      */
     static float NormalizeAxis(long value, long maxAxisAmount);
-    static float ScaleDeadzone(float value);
 
-    struct JoystickAxis
+    /*!
+     * Zero values within the deadzone and rescale the rest of the range to
+     * (0.0, 1.0], so that output is continuous at the edge of the deadzone
+     */
+    static float ScaleDeadzone(float value, float deadzone);
+
+    /*!
+     * Apply a deadzone to the distance of a stick from its center, keeping
+     * its direction
+     */
+    static void ScaleRadialDeadzone(float deadzone, float& x, float& y);
+
+    /*!
+     * Load the device's stored configuration, if any
+     *
+     * \return true if a configuration was found and applied
+     */
+    bool LoadConfiguration(void);
+
+    /*!
+     * Store a value that has been through calibration and the deadzone stage
+     */
+    void SetProcessedAxisValue(unsigned int axisIndex, JOYSTICK_STATE_AXIS axisValue);
+
+    // Elements stored inline, enough for typical gamepads. Devices with more
+    // elements use heap storage.
+    enum
     {
-      JOYSTICK_STATE_AXIS state = 0.0f;
-      bool bSeen = false;
+      INLINE_BUTTONS = 256,
+      INLINE_HATS    = 4,
+      INLINE_AXES    = 16,
     };
 
+    /*!
+     * State of all elements, stored as one array per field
+     */
     struct JoystickState
     {
-      std::vector<JOYSTICK_STATE_BUTTON> buttons;
-      std::vector<JOYSTICK_STATE_HAT>    hats;
-      std::vector<JoystickAxis>          axes;
+      CBitset<INLINE_BUTTONS>                         buttons;  // Buttons that are pressed
+      CInlineVector<JOYSTICK_STATE_HAT, INLINE_HATS>  hats;
+      CInlineVector<JOYSTICK_STATE_AXIS, INLINE_AXES> axes;
+      CBitset<INLINE_AXES>                            axesSeen; // Axes that have reported a value
+
+      void Reset(unsigned int buttonCount, unsigned int hatCount, unsigned int axisCount);
+    };
+
+    /*!
+     * Elements set since the last diff against the sent state. Buttons are
+     * diffed a word at a time, so they aren't tracked.
+     */
+    struct DirtyElements
+    {
+      CBitset<INLINE_HATS> hats;
+      CBitset<INLINE_AXES> axes;
+    };
+
+    /*!
+     * Processing applied to axis values before they are buffered
+     */
+    struct AxisCalibration
+    {
+      float scale = 1.0f;     // Trigger calibration, applied as value * scale + offset
+      float offset = 0.0f;
+      float deadzone = 0.0f;
+      int   stickAxis = -1;   // Other axis of the stick for a radial deadzone, or -1
+      float threshold = 0.0f; // Minimum change that produces an event, or 0 for the add-on setting
+
+      // Stored calibration that scale and offset were computed from
+      TriggerProperties trigger;
+    };
+
+    /*!
+     * Elements that the device configuration marks as ignored
+     */
+    struct IgnoredElements
+    {
+      CBitset<INLINE_BUTTONS> buttons;
+      CBitset<INLINE_AXES>    axes;
+    };
+
+    /*!
+     * Time of the most recent input for each element, or 0 if the element has
+     * no input that hasn't been turned into an event
+     */
+    struct InputTimes
+    {
+      CInlineVector<int64_t, INLINE_BUTTONS> buttons;
+      CInlineVector<int64_t, INLINE_HATS>    hats;
+      CInlineVector<int64_t, INLINE_AXES>    axes;
+    };
+
+    struct TimedEvent
+    {
+      ADDON::PeripheralEvent event;
+      int64_t                timestampUs = 0;
     };
 
-    JoystickState                     m_state;
-    JoystickState                     m_stateBuffer;
-    int64_t                           m_discoverTimeMs;
-    int64_t                           m_activateTimeMs;
-    int64_t                           m_firstEventTimeMs;
-    int64_t                           m_lastEventTimeMs;
+    JoystickState                         m_state;       // Last state sent to the frontend
+    JoystickState                         m_stateBuffer; // State reported by the driver
+    DirtyElements                         m_dirty;
+    CInlineVector<JOYSTICK_STATE_AXIS, INLINE_AXES> m_rawAxes; // Calibrated axis values before the deadzone
+    CInlineVector<AxisCalibration, INLINE_AXES>     m_calibration;
+    IgnoredElements                       m_ignored;
+    InputTimes                            m_inputTimes;
+    int64_t                               m_inputTimeUs;
+    std::vector<int64_t>                  m_eventTimes; // Input times of the events being read
+    CRingBuffer<TimedEvent>               m_eventQueue;
+    std::vector<TimedEvent>               m_eventLog; // Transitions in the order they were scanned
+    std::vector<ADDON::PeripheralEvent>   m_queueScratch;
+    CLatencyHistogram                     m_latency;
+    int64_t                               m_lastKeepAliveMs;
+    unsigned int                          m_droppedEventCount;
+    unsigned int                          m_droppedTransitionCount;
+    int64_t                               m_discoverTimeMs;
+    int64_t                               m_activateTimeMs;
+    int64_t                               m_firstEventTimeMs;
+    int64_t                               m_lastEventTimeMs;
+    std::atomic<bool>                     m_bWatched; // Read by GetEvents() without locking
+    bool                                  m_bInputPending;
+    bool                                  m_bLogTransitions;
+    bool                                  m_bSeedingState;
+    std::atomic<bool>                     m_bDisconnected;
   };
 }
@@ -45,34 +45,25 @@
 
 #include "log/Log.h"
 #include "settings/Settings.h"
+#include "storage/DeviceConfiguration.h"
+#include "storage/StorageManager.h"
 #include "utils/CommonMacros.h"
 
 #include <algorithm>
 #include <iterator>
+#include <unordered_set>
 
 using namespace JOYSTICK;
 using namespace P8PLATFORM;
 
+// Below this many joysticks, GetEvents() reads them serially even if the scan
+// pool is running, as waking the workers costs more than it saves
+#define PARALLEL_SCAN_MIN_JOYSTICKS  4
+
 // --- Utility functions -------------------------------------------------------
 
 namespace JOYSTICK
 {
-  struct ScanResultEqual
-  {
-    ScanResultEqual(const JoystickPtr& needle) : m_needle(needle) { }
-
-    bool operator()(const JoystickPtr& rhs)
-    {
-      if (m_needle)
-        return m_needle->Equals(rhs.get());
-
-      return m_needle == rhs;
-    }
-
-  private:
-    JoystickPtr const m_needle;
-  };
-
   template <class T>
   void safe_delete(T*& pVal)
   {
@@ -89,10 +80,66 @@ namespace JOYSTICK
   }
 }
 
+// --- CReadEventsJob ----------------------------------------------------------
+
+class CJoystickManager::CReadEventsJob : public IScanJob
+{
+public:
+  CReadEventsJob(CJoystickManager& manager, const JoystickVector& joysticks) :
+    m_manager(manager),
+    m_joysticks(joysticks)
+  {
+  }
+
+  virtual void Execute(unsigned int index) override
+  {
+    m_manager.GetJoystickEvents(*m_joysticks[index], m_manager.m_eventSlices[index]);
+  }
+
+private:
+  CJoystickManager&     m_manager;
+  const JoystickVector& m_joysticks;
+};
+
+// --- CScanInterfacesJob ------------------------------------------------------
+
+namespace JOYSTICK
+{
+  class CScanInterfacesJob : public IScanJob
+  {
+  public:
+    CScanInterfacesJob(const std::vector<IJoystickInterface*>& interfaces) :
+      m_interfaces(interfaces),
+      m_results(interfaces.size())
+    {
+    }
+
+    virtual void Execute(unsigned int index) override
+    {
+      m_interfaces[index]->ScanForJoysticks(m_results[index]);
+    }
+
+    void GetResults(JoystickVector& joysticks) const
+    {
+      for (const JoystickVector& results : m_results)
+        joysticks.insert(joysticks.end(), results.begin(), results.end());
+    }
+
+  private:
+    const std::vector<IJoystickInterface*>& m_interfaces;
+    std::vector<JoystickVector>             m_results; // Per interface
+  };
+}
+
 // --- CJoystickManager --------------------------------------------------------
 
 CJoystickManager::CJoystickManager(void)
   : m_scanner(NULL),
+    m_snapshot(std::make_shared<const JoystickVector>()),
+    m_inputThread(*this, m_reactor),
+    m_bThreadedInput(false),
+    m_scanThread(*this),
+    m_bScanResultPending(false),
     m_nextJoystickIndex(0),
     m_bChanged(false)
 {
@@ -172,6 +219,7 @@ bool CJoystickManager::Initialize(IScannerCallback* scanner)
   CLockObject lock(m_interfacesMutex);
 
   m_scanner = scanner;
+  m_scanDebouncer.SetScanner(scanner);
 
   const std::vector<EJoystickInterface>& interfaces = GetSupportedInterfaces();
 
@@ -185,14 +233,30 @@ bool CJoystickManager::Initialize(IScannerCallback* scanner)
   if (m_interfaces.empty())
     dsyslog("No joystick APIs in use");
 
+  if (!m_reactor.Initialize())
+    dsyslog("Input reactor unavailable, joysticks will be polled");
+
   return true;
 }
 
 void CJoystickManager::Deinitialize(void)
 {
+  SetAsyncScan(false);
+  SetInputThread(false);
+  SetScanThreads(0);
+
   {
     CLockObject lock(m_joystickMutex);
+    CLockObject eventLock(m_eventMutex);
+    CLockObject dequeueLock(m_dequeueMutex);
+    for (const JoystickPtr& joystick : m_joysticks)
+    {
+      joystick->LogLatencyStatistics();
+      m_reactor.Unregister(joystick.get());
+    }
     m_joysticks.clear();
+    PublishSnapshot();
+    m_reactor.Deinitialize();
   }
 
   {
@@ -202,6 +266,10 @@ void CJoystickManager::Deinitialize(void)
     safe_delete_vector(m_interfaces);
   }
 
+  m_scanDebouncer.Stop();
+  m_scanDebouncer.LogStatistics();
+  m_scanDebouncer.SetScanner(nullptr);
+
   m_scanner = NULL;
 }
 
@@ -272,6 +340,85 @@ void CJoystickManager::SetEnabled(EJoystickInterface iface, bool bEnabled)
   }
 }
 
+void CJoystickManager::SetInputThread(bool bEnabled)
+{
+  if (bEnabled)
+  {
+    {
+      CLockObject lock(m_eventMutex);
+
+      if (m_bThreadedInput)
+        return;
+
+      if (!m_reactor.IsInitialized())
+      {
+        esyslog("Input thread requires the input reactor, reading input in GetEvents()");
+        return;
+      }
+
+      // The reactor is now waited on by the input thread only
+      m_bThreadedInput = true;
+    }
+
+    isyslog("Starting input thread");
+    if (!m_inputThread.Start())
+    {
+      esyslog("Failed to start input thread");
+      CLockObject lock(m_eventMutex);
+      m_bThreadedInput = false;
+    }
+  }
+  else
+  {
+    m_inputThread.Stop();
+
+    CLockObject lock(m_eventMutex);
+    if (m_bThreadedInput)
+    {
+      isyslog("Stopped input thread");
+      m_bThreadedInput = false;
+    }
+  }
+}
+
+void CJoystickManager::SetScanThreads(unsigned int threadCount)
+{
+  CLockObject lock(m_eventMutex);
+
+  if (threadCount == m_scanPool.ThreadCount())
+    return;
+
+  if (threadCount == 0)
+    isyslog("Reading joysticks serially");
+  else
+    isyslog("Reading joysticks on %u threads", threadCount);
+
+  m_scanPool.Start(threadCount);
+}
+
+void CJoystickManager::SetAsyncScan(bool bEnabled)
+{
+  if (bEnabled)
+  {
+    if (!m_scanThread.IsRunning())
+    {
+      isyslog("Scanning for joysticks in the background");
+      if (!m_scanThread.Start())
+        esyslog("Failed to start scan thread");
+    }
+  }
+  else
+  {
+    m_scanThread.Stop();
+    m_bScanResultPending = false;
+  }
+}
+
+void CJoystickManager::SetScanDebounce(unsigned int windowMs, unsigned int minIntervalMs)
+{
+  m_scanDebouncer.Configure(windowMs, minIntervalMs);
+}
+
 bool CJoystickManager::IsEnabled(IJoystickInterface* iface)
 {
   CLockObject lock(m_interfacesMutex);
@@ -279,28 +426,115 @@ bool CJoystickManager::IsEnabled(IJoystickInterface* iface)
 }
 
 bool CJoystickManager::PerformJoystickScan(JoystickVector& joysticks)
+{
+  if (m_scanThread.IsRunning())
+  {
+    // Return the result of a finished background scan, or start a new scan
+    // and return the current joysticks. The frontend is asked to scan again
+    // when the background scan changes anything.
+    if (!m_bScanResultPending.exchange(false))
+      m_scanThread.RequestScan();
+  }
+  else
+  {
+    JoystickVector scanResults;
+    {
+      CLockObject lock(m_interfacesMutex);
+      // Scan for joysticks (this can take a while, don't block)
+      for (auto pInterface : m_enabledInterfaces)
+        pInterface->ScanForJoysticks(scanResults);
+    }
+
+    UpdateJoysticks(scanResults);
+  }
+
+  joysticks = *GetSnapshot();
+
+  joysticks.erase(std::remove_if(joysticks.begin(), joysticks.end(),
+    [](const JoystickPtr& joystick)
+    {
+      // A joystick unplugged since the last scan stays in the snapshot until
+      // the next scan removes it
+      if (joystick->IsDisconnected())
+        return true;
+
+      // Work around bug on linux: Don't return disconnected Xbox 360 controllers
+      return CJoystickUtils::IsGhostJoystick(*joystick) &&
+             !joystick->IsActive();
+    }), joysticks.end());
+
+  return true;
+}
+
+void CJoystickManager::PerformBackgroundScan(CScanPool& pool)
 {
   JoystickVector scanResults;
   {
     CLockObject lock(m_interfacesMutex);
-    // Scan for joysticks (this can take a while, don't block)
-    for (auto pInterface : m_enabledInterfaces)
-      pInterface->ScanForJoysticks(scanResults);
+
+    std::vector<IJoystickInterface*> interfaces(m_enabledInterfaces.begin(), m_enabledInterfaces.end());
+
+    // Interfaces are independent, so each one is scanned on its own thread
+    if (interfaces.size() > 1 && pool.ThreadCount() != interfaces.size() - 1)
+      pool.Start(static_cast<unsigned int>(interfaces.size() - 1));
+
+    CScanInterfacesJob job(interfaces);
+    pool.Run(job, static_cast<unsigned int>(interfaces.size()));
+    job.GetResults(scanResults);
   }
 
+  if (UpdateJoysticks(scanResults))
+  {
+    m_bScanResultPending = true;
+
+    if (m_scanner)
+      m_scanner->TriggerScan();
+  }
+}
+
+bool CJoystickManager::UpdateJoysticks(const JoystickVector& scanResults)
+{
+  // Serializes scans. Event delivery reads the published snapshot and is
+  // never blocked by this lock.
   CLockObject lock(m_joystickMutex);
 
-  // Unregister removed joysticks
+  JoystickVector removedJoysticks;
+  JoystickVector addedJoysticks;
+
+  // Reconcile by identity instead of comparing every pair with Equals()
+  std::unordered_set<std::string> scannedIdentities;
+  scannedIdentities.reserve(scanResults.size());
+  for (const JoystickPtr& joystick : scanResults)
+    scannedIdentities.insert(joystick->Identity());
+
+  std::unordered_set<std::string> knownIdentities;
+  knownIdentities.reserve(m_joysticks.size() + scanResults.size());
+
+  // Find removed joysticks
   for (int i = (int)m_joysticks.size() - 1; i >= 0; i--)
   {
-    if (std::find_if(scanResults.begin(), scanResults.end(), ScanResultEqual(m_joysticks.at(i))) == scanResults.end())
+    std::string identity = m_joysticks.at(i)->Identity();
+    if (m_joysticks.at(i)->IsDisconnected() || scannedIdentities.find(identity) == scannedIdentities.end())
+    {
+      removedJoysticks.push_back(m_joysticks.at(i));
       m_joysticks.erase(m_joysticks.begin() + i);
+    }
+    else
+    {
+      knownIdentities.insert(std::move(identity));
+    }
   }
 
-  // Register new joysticks
-  for (JoystickVector::iterator itJoystick = scanResults.begin(); itJoystick != scanResults.end(); ++itJoystick)
+  // Initialize new joysticks. They aren't visible to readers until the
+  // snapshot is published.
+  for (JoystickVector::const_iterator itJoystick = scanResults.begin(); itJoystick != scanResults.end(); ++itJoystick)
   {
-    if (std::find_if(m_joysticks.begin(), m_joysticks.end(), ScanResultEqual(*itJoystick)) == m_joysticks.end())
+    // Unplugged devices can still be reported until the interface notices
+    if ((*itJoystick)->IsDisconnected())
+      continue;
+
+    // Also skips duplicate scan results
+    if (knownIdentities.insert((*itJoystick)->Identity()).second)
     {
       if ((*itJoystick)->Initialize())
       {
@@ -310,29 +544,42 @@ bool CJoystickManager::PerformJoystickScan(JoystickVector& joysticks)
                 (*itJoystick)->Index(), (*itJoystick)->Name().c_str(),
                 (*itJoystick)->AxisCount(), (*itJoystick)->HatCount(), (*itJoystick)->ButtonCount());
 
+        addedJoysticks.push_back(*itJoystick);
         m_joysticks.push_back(*itJoystick);
       }
     }
   }
 
-  joysticks = m_joysticks;
+  if (!removedJoysticks.empty() || !addedJoysticks.empty())
+  {
+    // Wait for readers of the previous snapshot to finish. Readers that start
+    // after the swap see the new list, so removed joysticks can be
+    // unregistered safely.
+    CLockObject eventLock(m_eventMutex);
+
+    for (const JoystickPtr& joystick : addedJoysticks)
+      m_reactor.Register(joystick.get());
 
-  // Work around bug on linux: Don't return disconnected Xbox 360 controllers
-  joysticks.erase(std::remove_if(joysticks.begin(), joysticks.end(),
-    [](const JoystickPtr& joystick)
+    PublishSnapshot();
+
+    // Latency statistics are updated by GetEvents() while draining the queues
+    CLockObject dequeueLock(m_dequeueMutex);
+
+    for (const JoystickPtr& joystick : removedJoysticks)
     {
-      return CJoystickUtils::IsGhostJoystick(*joystick) &&
-             !joystick->IsActive();
-    }), joysticks.end());
+      joystick->LogLatencyStatistics();
+      m_reactor.Unregister(joystick.get());
+    }
+  }
 
-  return true;
+  return !removedJoysticks.empty() || !addedJoysticks.empty();
 }
 
 JoystickPtr CJoystickManager::GetJoystick(unsigned int index) const
 {
-  CLockObject lock(m_joystickMutex);
+  JoystickSnapshot joysticks = GetSnapshot();
 
-  for (JoystickVector::const_iterator it = m_joysticks.begin(); it != m_joysticks.end(); ++it)
+  for (JoystickVector::const_iterator it = joysticks->begin(); it != joysticks->end(); ++it)
   {
     if ((*it)->Index() == index)
       return *it;
@@ -345,9 +592,9 @@ JoystickVector CJoystickManager::GetJoysticks(const ADDON::Joystick& joystickInf
 {
   JoystickVector result;
 
-  CLockObject lock(m_joystickMutex);
+  JoystickSnapshot joysticks = GetSnapshot();
 
-  for (const auto& joystick : m_joysticks)
+  for (const auto& joystick : *joysticks)
   {
     if (joystick->Name() == joystickInfo.Name() &&
         joystick->Provider() == joystickInfo.Provider())
@@ -359,23 +606,144 @@ JoystickVector CJoystickManager::GetJoysticks(const ADDON::Joystick& joystickInf
   return result;
 }
 
+JoystickVector CJoystickManager::GetDeviceJoysticks(const ADDON::Joystick& deviceInfo) const
+{
+  JoystickVector result;
+
+  JoystickSnapshot joysticks = GetSnapshot();
+
+  for (const auto& joystick : *joysticks)
+  {
+    if (joystick->Name() == deviceInfo.Name() &&
+        joystick->Provider() == deviceInfo.Provider() &&
+        joystick->VendorID() == deviceInfo.VendorID() &&
+        joystick->ProductID() == deviceInfo.ProductID() &&
+        joystick->ButtonCount() == deviceInfo.ButtonCount() &&
+        joystick->HatCount() == deviceInfo.HatCount() &&
+        joystick->AxisCount() == deviceInfo.AxisCount())
+    {
+      result.push_back(joystick);
+    }
+  }
+
+  return result;
+}
+
+void CJoystickManager::ReloadConfiguration(const ADDON::Joystick& joystickInfo)
+{
+  // Only joysticks with the stored layout, a configuration is applied by index
+  JoystickVector joysticks = GetDeviceJoysticks(joystickInfo);
+  if (joysticks.empty())
+    return;
+
+  // Query storage before locking, the configuration is applied between reads
+  CDeviceConfiguration configuration;
+  CStorageManager::Get().GetDeviceConfiguration(joystickInfo, configuration);
+
+  CLockObject lock(m_eventMutex);
+
+  for (const JoystickPtr& joystick : joysticks)
+    joystick->SetConfiguration(configuration);
+}
+
+void CJoystickManager::GetAppliedTriggers(const ADDON::Joystick& joystickInfo, TriggerPropertiesMap& triggers)
+{
+  // Without a joystick of the exact layout, no calibration is applied
+  JoystickVector joysticks = GetDeviceJoysticks(joystickInfo);
+  if (joysticks.empty())
+    return;
+
+  // Calibrations are replaced between reads
+  CLockObject lock(m_eventMutex);
+
+  // These joysticks share one stored configuration
+  joysticks.front()->GetAppliedTriggers(triggers);
+}
+
 bool CJoystickManager::GetEvents(std::vector<ADDON::PeripheralEvent>& events)
 {
-  CLockObject lock(m_joystickMutex);
+  JoystickSnapshot joysticks = GetSnapshot();
+
+  // Collect events queued by the input thread, including any left over from
+  // before the thread was stopped. The queues have a single consumer, so this
+  // doesn't wait for the input thread to finish reading the kernel.
+  bool bReadRequired = !m_bThreadedInput;
+  {
+    CLockObject dequeueLock(m_dequeueMutex);
+    for (const JoystickPtr& joystick : *joysticks)
+    {
+      joystick->DequeueEvents(events);
+      if (!joystick->IsWatched())
+        bReadRequired = true;
+    }
+  }
+
+  if (!bReadRequired)
+    return true;
+
+  CLockObject lock(m_eventMutex);
+
+  // Removed joysticks are only unregistered once readers of the previous
+  // snapshot are done, so read from the snapshot taken under the lock
+  joysticks = GetSnapshot();
+
+  // Flag the joysticks with pending input so the rest can skip the kernel
+  if (!m_bThreadedInput)
+    m_reactor.Poll();
+
+  if (m_scanPool.ThreadCount() > 0 && joysticks->size() >= PARALLEL_SCAN_MIN_JOYSTICKS)
+  {
+    // Read each joystick into its own slice, then concatenate the slices so
+    // that events are ordered by joystick as if they were read serially
+    if (m_eventSlices.size() < joysticks->size())
+      m_eventSlices.resize(joysticks->size());
+
+    for (unsigned int i = 0; i < joysticks->size(); i++)
+      m_eventSlices[i].clear();
+
+    CReadEventsJob job(*this, *joysticks);
+    m_scanPool.Run(job, static_cast<unsigned int>(joysticks->size()));
 
-  for (JoystickVector::iterator it = m_joysticks.begin(); it != m_joysticks.end(); ++it)
-    (*it)->GetEvents(events);
+    for (unsigned int i = 0; i < joysticks->size(); i++)
+      events.insert(events.end(), m_eventSlices[i].begin(), m_eventSlices[i].end());
+  }
+  else
+  {
+    for (JoystickVector::const_iterator it = joysticks->begin(); it != joysticks->end(); ++it)
+      GetJoystickEvents(**it, events);
+  }
 
   return true;
 }
 
+void CJoystickManager::GetJoystickEvents(CJoystick& joystick, std::vector<ADDON::PeripheralEvent>& events)
+{
+  if (!m_bThreadedInput || !joystick.IsWatched())
+    joystick.GetEvents(events);
+}
+
+void CJoystickManager::QueueEvents(void)
+{
+  CLockObject lock(m_eventMutex);
+
+  JoystickSnapshot joysticks = GetSnapshot();
+
+  m_reactor.Dispatch();
+
+  for (const JoystickPtr& joystick : *joysticks)
+  {
+    if (joystick->IsWatched())
+      joystick->QueueEvents();
+  }
+}
+
 bool CJoystickManager::SendEvent(const ADDON::PeripheralEvent& event)
 {
   bool bHandled = false;
 
-  CLockObject lock(m_joystickMutex);
+  JoystickSnapshot joysticks = GetSnapshot();
 
-  for (const JoystickPtr& joystick : m_joysticks)
+  for (const JoystickPtr& joystick : *joysticks)
   {
     if (joystick->Index() == event.PeripheralIndex())
     {
@@ -390,10 +758,13 @@ bool CJoystickManager::SendEvent(const ADDON::PeripheralEvent& event)
 
 void CJoystickManager::ProcessEvents()
 {
-  CLockObject lock(m_joystickMutex);
+  JoystickSnapshot joysticks = GetSnapshot();
 
-  for (const JoystickPtr& joystick : m_joysticks)
-    joystick->ProcessEvents();
+  for (const JoystickPtr& joystick : *joysticks)
+  {
+    if (!joystick->IsDisconnected())
+      joystick->ProcessEvents();
+  }
 }
 
 void CJoystickManager::SetChanged(bool bChanged)
@@ -411,8 +782,18 @@ void CJoystickManager::TriggerScan(void)
     m_bChanged = false;
   }
 
-  if (bChanged && m_scanner)
-    m_scanner->TriggerScan();
+  if (bChanged)
+    m_scanDebouncer.Trigger();
+}
+
+CJoystickManager::JoystickSnapshot CJoystickManager::GetSnapshot(void) const
+{
+  return std::atomic_load(&m_snapshot);
+}
+
+void CJoystickManager::PublishSnapshot(void)
+{
+  std::atomic_store(&m_snapshot, std::make_shared<const JoystickVector>(m_joysticks));
 }
 
 const ButtonMap& CJoystickManager::GetButtonMap(const std::string& provider)
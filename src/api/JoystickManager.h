@@ -19,12 +19,20 @@
  */
 #pragma once
 
+#include "InputReactor.h"
+#include "InputThread.h"
+#include "ScanDebouncer.h"
 #include "JoystickTypes.h"
+#include "ScanPool.h"
+#include "ScanThread.h"
 #include "buttonmapper/ButtonMapTypes.h"
+#include "storage/PrimitiveConfiguration.h"
 
 #include "kodi_peripheral_utils.hpp"
 #include "p8-platform/threads/mutex.h"
 
+#include <atomic>
+#include <memory>
 #include <set>
 #include <vector>
 
@@ -95,6 +103,61 @@ namespace JOYSTICK
      */
     void SetEnabled(EJoystickInterface iface, bool bEnabled);
 
+    /*!
+     * \brief Read input from watched joysticks on a dedicated thread
+     *
+     * \param bEnabled True to start the input thread, false to scan joysticks
+     *                 in GetEvents()
+     */
+    void SetInputThread(bool bEnabled);
+
+    /*!
+     * \brief Set the number of threads used to read joysticks in GetEvents()
+     *
+     * \param threadCount The number of worker threads, or 0 to read joysticks
+     *                    serially on the calling thread
+     */
+    void SetScanThreads(unsigned int threadCount);
+
+    /*!
+     * \brief Scan for joysticks on a background thread
+     *
+     * \param bEnabled True to return the result of the most recent background
+     *                 scan from PerformJoystickScan(), false to scan on the
+     *                 calling thread
+     */
+    void SetAsyncScan(bool bEnabled);
+
+    /*!
+     * \brief Coalesce the scans triggered by TriggerScan()
+     *
+     * \param windowMs      Time to wait for further changes before scanning
+     * \param minIntervalMs Minimum time between scans
+     */
+    void SetScanDebounce(unsigned int windowMs, unsigned int minIntervalMs);
+
+    /*!
+     * \brief Reload the stored configuration of the matching joysticks
+     *
+     * Called when the storage layer changes a device's configuration, such as
+     * its ignored primitives, so that the change applies to live joysticks.
+     *
+     * \param joystickInfo The device whose configuration changed
+     */
+    void ReloadConfiguration(const ADDON::Joystick& joystickInfo);
+
+    /*!
+     * \brief Get the trigger calibrations that connected joysticks apply to
+     *        a device's axes
+     *
+     * Axes that aren't calibrated by the add-on are sent to the frontend raw.
+     *
+     * \param joystickInfo The device
+     * \param triggers The calibration of each calibrated axis, or empty if no
+     *                 joystick with the device's layout is connected
+     */
+    void GetAppliedTriggers(const ADDON::Joystick& joystickInfo, TriggerPropertiesMap& triggers);
+
     /*!
      * \brief Check the state of the specified interface
      *
@@ -113,6 +176,14 @@ namespace JOYSTICK
      */
     bool PerformJoystickScan(JoystickVector& joysticks);
 
+    /*!
+     * \brief Scan the enabled interfaces in parallel and publish the result.
+     *        Called by the scan thread.
+     *
+     * The frontend is asked to scan again if the joysticks changed.
+     */
+    void PerformBackgroundScan(CScanPool& pool);
+
     JoystickPtr GetJoystick(unsigned int index) const;
 
     JoystickVector GetJoysticks(const ADDON::Joystick& joystickInfo) const;
@@ -122,6 +193,12 @@ namespace JOYSTICK
     */
     bool GetEvents(std::vector<ADDON::PeripheralEvent>& events);
 
+    /*!
+     * \brief Queue events from joysticks with pending input. Called by the
+     *        input thread.
+     */
+    void QueueEvents(void);
+
     /*!
      * \brief Send an event to a joystick
      *
@@ -142,7 +219,8 @@ namespace JOYSTICK
     void SetChanged(bool bChanged);
 
     /*!
-     * \brief Trigger a scan for joysticks through the callback, if changed
+     * \brief Trigger a scan for joysticks through the callback, if changed.
+     *        Scans may be coalesced, see SetScanDebounce().
      */
     void TriggerScan(void);
 
@@ -156,14 +234,61 @@ namespace JOYSTICK
     const ButtonMap& GetButtonMap(const std::string& provider);
 
   private:
+    typedef std::shared_ptr<const JoystickVector> JoystickSnapshot;
+
+    class CReadEventsJob;
+
+    /*!
+     * \brief Reconcile the joystick list with the result of a scan and publish
+     *        it
+     *
+     * \return true if joysticks were added or removed
+     */
+    bool UpdateJoysticks(const JoystickVector& scanResults);
+
+    /*!
+     * \brief Get the events of a single joystick for GetEvents()
+     */
+    void GetJoystickEvents(CJoystick& joystick, std::vector<ADDON::PeripheralEvent>& events);
+
+    /*!
+     * \brief Get the joysticks that share a device's stored configuration
+     *
+     * Matches the fields that identify a device in storage: name, provider,
+     * VID/PID and button, hat and axis counts. The index is ignored, as it is
+     * assigned by the add-on.
+     */
+    JoystickVector GetDeviceJoysticks(const ADDON::Joystick& deviceInfo) const;
+
+    /*!
+     * \brief Get the most recently published list of joysticks without locking
+     */
+    JoystickSnapshot GetSnapshot(void) const;
+
+    /*!
+     * \brief Publish the current value of m_joysticks to readers
+     */
+    void PublishSnapshot(void);
+
     IScannerCallback*                m_scanner;
     std::vector<IJoystickInterface*> m_interfaces;
     std::set<IJoystickInterface*>    m_enabledInterfaces;
-    JoystickVector                   m_joysticks;
+    JoystickVector                   m_joysticks; // Owned by the scan, guarded by m_joystickMutex
+    JoystickSnapshot                 m_snapshot;  // Read and replaced atomically
+    CInputReactor                    m_reactor;
+    CInputThread                     m_inputThread;
+    std::atomic<bool>                m_bThreadedInput;
+    CScanPool                        m_scanPool;
+    CScanThread                      m_scanThread;
+    std::atomic<bool>                m_bScanResultPending;
+    CScanDebouncer                   m_scanDebouncer;
+    std::vector<std::vector<ADDON::PeripheralEvent>> m_eventSlices; // Per-joystick events of a parallel scan
     unsigned int                     m_nextJoystickIndex;
     bool                             m_bChanged;
     mutable P8PLATFORM::CMutex       m_changedMutex;
     mutable P8PLATFORM::CMutex         m_interfacesMutex;
     mutable P8PLATFORM::CMutex         m_joystickMutex;
+    mutable P8PLATFORM::CMutex         m_eventMutex; // Serializes reading input from joysticks
+    mutable P8PLATFORM::CMutex         m_dequeueMutex; // Serializes consumers of the event queues
   };
 }
@@ -22,6 +22,12 @@
 #include <memory>
 #include <vector>
 
+/*!
+ * \brief Upper bound on the time a background thread blocks before checking
+ *        whether it has been stopped
+ */
+#define THREAD_STOP_TIMEOUT_MS  100
+
 namespace JOYSTICK
 {
   /*!
@@ -22,6 +22,8 @@
 #include "JoystickTranslator.h"
 #include "JoystickTypes.h"
 
+#include <chrono>
+
 using namespace JOYSTICK;
 
 bool CJoystickUtils::IsGhostJoystick(const CJoystick& joystick)
@@ -40,3 +42,10 @@ bool CJoystickUtils::IsGhostJoystick(const CJoystick& joystick)
 
   return false;
 }
+
+int64_t CJoystickUtils::GetMonotonicTimeUs(void)
+{
+  // steady_clock is backed by CLOCK_MONOTONIC on Linux
+  using namespace std::chrono;
+  return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
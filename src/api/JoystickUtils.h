@@ -18,6 +18,8 @@
  */
 #pragma once
 
+#include <stdint.h>
+
 namespace JOYSTICK
 {
   class CJoystick;
@@ -30,5 +32,13 @@ namespace JOYSTICK
      *        reports a joystick attached, even though none is present
      */
     static bool IsGhostJoystick(const CJoystick& joystick);
+
+    /*!
+     * \brief Get the current time in microseconds
+     *
+     * On Linux, this uses CLOCK_MONOTONIC, the clock that evdev timestamps are
+     * switched to with EVIOCSCLOCKID.
+     */
+    static int64_t GetMonotonicTimeUs(void);
   };
 }
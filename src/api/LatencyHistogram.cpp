@@ -0,0 +1,95 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ */
+
+#include "LatencyHistogram.h"
+
+using namespace JOYSTICK;
+
+void CLatencyHistogram::Reset(void)
+{
+  m_buckets.fill(0);
+  m_count = 0;
+  m_maxUs = 0;
+}
+
+void CLatencyHistogram::Add(int64_t latencyUs)
+{
+  // Clocks can disagree by a few microseconds
+  if (latencyUs < 0)
+    latencyUs = 0;
+
+  uint32_t& bucket = m_buckets[BucketIndex(static_cast<uint64_t>(latencyUs))];
+  if (bucket < UINT32_MAX)
+    bucket++;
+
+  m_count++;
+
+  if (latencyUs > m_maxUs)
+    m_maxUs = latencyUs;
+}
+
+int64_t CLatencyHistogram::PercentileUs(float percentile) const
+{
+  if (m_count == 0)
+    return 0;
+
+  uint64_t target = static_cast<uint64_t>(percentile * m_count);
+  if (target >= m_count)
+    target = m_count - 1;
+
+  uint64_t seen = 0;
+  for (unsigned int i = 0; i < BUCKET_COUNT; i++)
+  {
+    seen += m_buckets[i];
+    if (seen > target)
+    {
+      const int64_t upperBound = BucketUpperBound(i);
+      return upperBound < m_maxUs ? upperBound : m_maxUs;
+    }
+  }
+
+  return m_maxUs;
+}
+
+unsigned int CLatencyHistogram::BucketIndex(uint64_t latencyUs)
+{
+  if (latencyUs < LINEAR_LIMIT)
+    return static_cast<unsigned int>(latencyUs);
+
+  // Position of the highest set bit, at least 4 because LINEAR_LIMIT is 16
+  unsigned int exponent = 0;
+  for (uint64_t value = latencyUs; value > 1; value >>= 1)
+    exponent++;
+
+  const unsigned int subBucket = static_cast<unsigned int>(latencyUs >> (exponent - 3)) & (SUB_BUCKETS - 1);
+
+  return LINEAR_LIMIT + (exponent - 4) * SUB_BUCKETS + subBucket;
+}
+
+int64_t CLatencyHistogram::BucketUpperBound(unsigned int index)
+{
+  if (index < LINEAR_LIMIT)
+    return index;
+
+  const unsigned int exponent = (index - LINEAR_LIMIT) / SUB_BUCKETS + 4;
+  const unsigned int subBucket = (index - LINEAR_LIMIT) % SUB_BUCKETS;
+
+  // Bucket covers [(8 + sub) << (exp - 3), (9 + sub) << (exp - 3))
+  return static_cast<int64_t>(((SUB_BUCKETS + subBucket + 1ULL) << (exponent - 3)) - 1);
+}
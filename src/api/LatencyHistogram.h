@@ -0,0 +1,67 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <array>
+#include <stdint.h>
+
+namespace JOYSTICK
+{
+  /*!
+   * \brief Fixed-size histogram of latencies in microseconds
+   *
+   * Values are grouped into power-of-two ranges, each split into eight
+   * linear buckets, so percentiles are accurate to within 12.5%. Adding a
+   * sample never allocates.
+   */
+  class CLatencyHistogram
+  {
+  public:
+    CLatencyHistogram(void) { Reset(); }
+
+    void Reset(void);
+
+    void Add(int64_t latencyUs);
+
+    uint64_t Count(void) const { return m_count; }
+    int64_t  MaxUs(void) const { return m_maxUs; }
+
+    /*!
+     * \brief Get the latency below which the given fraction of samples fall
+     *
+     * \param percentile The fraction, in the interval [0.0, 1.0]
+     *
+     * \return The upper bound of the bucket containing the percentile, or 0
+     *         if no samples have been added
+     */
+    int64_t PercentileUs(float percentile) const;
+
+  private:
+    static unsigned int BucketIndex(uint64_t latencyUs);
+    static int64_t BucketUpperBound(unsigned int index);
+
+    static const unsigned int SUB_BUCKETS = 8;
+    static const unsigned int LINEAR_LIMIT = 2 * SUB_BUCKETS; // Values below are exact
+    static const unsigned int BUCKET_COUNT = LINEAR_LIMIT + (64 - 4) * SUB_BUCKETS;
+
+    std::array<uint32_t, BUCKET_COUNT> m_buckets;
+    uint64_t m_count;
+    int64_t  m_maxUs;
+  };
+}
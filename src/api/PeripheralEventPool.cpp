@@ -0,0 +1,149 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ */
+
+#include "PeripheralEventPool.h"
+#include "log/Log.h"
+
+using namespace JOYSTICK;
+using namespace P8PLATFORM;
+
+// Initial capacity, enough for a few pads changing at once
+#define MIN_ARRAY_SIZE  64
+
+CPeripheralEventPool::CPeripheralEventPool(void)
+  : m_eventVectorCapacity(0),
+    m_acquireCount(0),
+    m_allocationCount(0)
+{
+}
+
+CPeripheralEventPool& CPeripheralEventPool::Get(void)
+{
+  static CPeripheralEventPool _instance;
+  return _instance;
+}
+
+void CPeripheralEventPool::Deinitialize(void)
+{
+  CLockObject lock(m_mutex);
+
+  LogStatistics();
+
+  // Arrays still held by the frontend are freed by Release()
+  for (auto it = m_arrays.begin(); it != m_arrays.end(); )
+  {
+    if (it->bInUse)
+      ++it;
+    else
+      it = m_arrays.erase(it);
+  }
+}
+
+std::vector<ADDON::PeripheralEvent>& CPeripheralEventPool::GetEventVector(void)
+{
+  m_eventVector.clear();
+  return m_eventVector;
+}
+
+PERIPHERAL_EVENT* CPeripheralEventPool::Acquire(const std::vector<ADDON::PeripheralEvent>& events)
+{
+  CLockObject lock(m_mutex);
+
+  m_acquireCount++;
+
+  // Count growth of the collection vector as well
+  if (m_eventVector.capacity() != m_eventVectorCapacity)
+  {
+    m_eventVectorCapacity = m_eventVector.capacity();
+    m_allocationCount++;
+  }
+
+  if (events.empty())
+    return nullptr;
+
+  EventArray* freeArray = nullptr;
+  for (EventArray& eventArray : m_arrays)
+  {
+    if (!eventArray.bInUse)
+    {
+      freeArray = &eventArray;
+      if (eventArray.capacity >= events.size())
+        break;
+    }
+  }
+
+  if (freeArray == nullptr)
+  {
+    m_arrays.emplace_back();
+    freeArray = &m_arrays.back();
+    m_allocationCount++;
+  }
+
+  if (freeArray->capacity < events.size())
+  {
+    size_t capacity = MIN_ARRAY_SIZE;
+    while (capacity < events.size())
+      capacity *= 2;
+
+    freeArray->events.reset(new PERIPHERAL_EVENT[capacity]);
+    freeArray->capacity = capacity;
+    m_allocationCount++;
+  }
+
+  for (unsigned int i = 0; i < events.size(); i++)
+    events[i].ToStruct(freeArray->events[i]);
+
+  freeArray->bInUse = true;
+
+  return freeArray->events.get();
+}
+
+void CPeripheralEventPool::Release(unsigned int eventCount, PERIPHERAL_EVENT* events)
+{
+  if (events == nullptr)
+    return;
+
+  CLockObject lock(m_mutex);
+
+  for (EventArray& eventArray : m_arrays)
+  {
+    if (eventArray.events.get() == events)
+    {
+      for (unsigned int i = 0; i < eventCount; i++)
+        ADDON::PeripheralEvent::FreeStruct(events[i]);
+
+      eventArray.bInUse = false;
+      return;
+    }
+  }
+
+  esyslog("Released unknown event array");
+}
+
+void CPeripheralEventPool::LogStatistics(void) const
+{
+  CLockObject lock(m_mutex);
+
+  if (m_acquireCount == 0)
+    return;
+
+  dsyslog("Event pool: %llu event arrays, %llu heap allocations",
+          static_cast<unsigned long long>(m_acquireCount),
+          static_cast<unsigned long long>(m_allocationCount));
+}
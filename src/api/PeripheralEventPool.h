@@ -0,0 +1,88 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "kodi_peripheral_utils.hpp"
+#include "p8-platform/threads/mutex.h"
+
+#include <memory>
+#include <stdint.h>
+#include <vector>
+
+namespace JOYSTICK
+{
+  /*!
+   * \brief Reusable storage for the event arrays handed to the frontend
+   *
+   * ADDON::PeripheralEvents::ToStructs() allocates a new array for every call
+   * to GetEvents(), which FreeEvents() then deletes. The pool keeps released
+   * arrays and hands them out again, so steady-state polling performs no heap
+   * allocations. Arrays only grow when a poll returns more events than any
+   * poll before it.
+   */
+  class CPeripheralEventPool
+  {
+  private:
+    CPeripheralEventPool(void);
+
+  public:
+    static CPeripheralEventPool& Get(void);
+    ~CPeripheralEventPool(void) { Deinitialize(); }
+
+    void Deinitialize(void);
+
+    /*!
+     * \brief Get a vector for collecting events before they are converted
+     *
+     * The vector is cleared but keeps its capacity. Only the caller of the
+     * add-on's GetEvents() may use it.
+     */
+    std::vector<ADDON::PeripheralEvent>& GetEventVector(void);
+
+    /*!
+     * \brief Convert events into a pooled array
+     *
+     * \return The array, or nullptr if there are no events. Must be returned
+     *         with Release().
+     */
+    PERIPHERAL_EVENT* Acquire(const std::vector<ADDON::PeripheralEvent>& events);
+
+    /*!
+     * \brief Return an array obtained from Acquire()
+     */
+    void Release(unsigned int eventCount, PERIPHERAL_EVENT* events);
+
+    void LogStatistics(void) const;
+
+  private:
+    struct EventArray
+    {
+      std::unique_ptr<PERIPHERAL_EVENT[]> events;
+      size_t                              capacity = 0;
+      bool                                bInUse = false;
+    };
+
+    std::vector<EventArray>             m_arrays;
+    std::vector<ADDON::PeripheralEvent> m_eventVector;
+    size_t                              m_eventVectorCapacity;
+    uint64_t                            m_acquireCount;
+    uint64_t                            m_allocationCount;
+    mutable P8PLATFORM::CMutex          m_mutex;
+  };
+}
@@ -0,0 +1,167 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ */
+
+#include "ScanDebouncer.h"
+#include "JoystickManager.h"
+#include "JoystickTypes.h"
+#include "log/Log.h"
+
+#include "p8-platform/util/timeutils.h"
+
+#include <algorithm>
+
+using namespace JOYSTICK;
+using namespace P8PLATFORM;
+
+CScanDebouncer::CScanDebouncer(void)
+  : m_scanner(nullptr),
+    m_windowMs(0),
+    m_minIntervalMs(0),
+    m_bPending(false),
+    m_deadlineMs(0),
+    m_lastScanMs(-1),
+    m_triggerCount(0),
+    m_scanCount(0)
+{
+}
+
+void CScanDebouncer::SetScanner(IScannerCallback* scanner)
+{
+  CLockObject lock(m_mutex);
+  m_scanner = scanner;
+}
+
+void CScanDebouncer::Configure(unsigned int windowMs, unsigned int minIntervalMs)
+{
+  {
+    CLockObject lock(m_mutex);
+    m_windowMs = windowMs;
+    m_minIntervalMs = minIntervalMs;
+  }
+
+  if (windowMs == 0 && minIntervalMs == 0)
+  {
+    Stop();
+
+    // Don't lose a scan that was waiting for the window to close
+    IScannerCallback* scanner = nullptr;
+    {
+      CLockObject lock(m_mutex);
+      if (m_bPending)
+      {
+        m_bPending = false;
+        m_scanCount++;
+        scanner = m_scanner;
+      }
+    }
+
+    if (scanner)
+      scanner->TriggerScan();
+  }
+  else if (!IsRunning())
+  {
+    CreateThread();
+  }
+}
+
+void CScanDebouncer::Stop(void)
+{
+  StopThread(0);
+}
+
+void CScanDebouncer::Trigger(void)
+{
+  IScannerCallback* scanner = nullptr;
+
+  {
+    CLockObject lock(m_mutex);
+
+    m_triggerCount++;
+
+    if (IsRunning())
+    {
+      // Later requests are folded into the pending scan
+      if (!m_bPending)
+      {
+        int64_t deadlineMs = GetTimeMs() + m_windowMs;
+        if (m_lastScanMs >= 0)
+          deadlineMs = std::max(deadlineMs, m_lastScanMs + m_minIntervalMs);
+
+        m_deadlineMs = deadlineMs;
+        m_bPending = true;
+        m_event.Signal();
+      }
+      return;
+    }
+
+    scanner = m_scanner;
+    m_scanCount++;
+  }
+
+  if (scanner)
+    scanner->TriggerScan();
+}
+
+void* CScanDebouncer::Process(void)
+{
+  while (!IsStopped())
+  {
+    IScannerCallback* scanner = nullptr;
+    uint32_t waitMs = THREAD_STOP_TIMEOUT_MS;
+
+    {
+      CLockObject lock(m_mutex);
+
+      if (m_bPending)
+      {
+        const int64_t nowMs = GetTimeMs();
+        if (nowMs >= m_deadlineMs)
+        {
+          m_bPending = false;
+          m_lastScanMs = nowMs;
+          m_scanCount++;
+          scanner = m_scanner;
+        }
+        else
+        {
+          waitMs = static_cast<uint32_t>(std::min<int64_t>(m_deadlineMs - nowMs, THREAD_STOP_TIMEOUT_MS));
+        }
+      }
+    }
+
+    if (scanner)
+      scanner->TriggerScan();
+    else
+      m_event.Wait(waitMs);
+  }
+
+  return nullptr;
+}
+
+void CScanDebouncer::LogStatistics(void) const
+{
+  CLockObject lock(m_mutex);
+
+  if (m_triggerCount == 0)
+    return;
+
+  dsyslog("Scan debouncer: %llu scans requested, %llu scans issued",
+          static_cast<unsigned long long>(m_triggerCount),
+          static_cast<unsigned long long>(m_scanCount));
+}
@@ -0,0 +1,88 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "p8-platform/threads/mutex.h"
+#include "p8-platform/threads/threads.h"
+
+#include <stdint.h>
+
+namespace JOYSTICK
+{
+  class IScannerCallback;
+
+  /*!
+   * \brief Coalesces requests to scan for joysticks
+   *
+   * The first request starts a window. Any requests made before the window
+   * closes are folded into a single scan at the end of the window. Scans are
+   * also spaced by a minimum interval, so a hotplug storm (such as a hub of
+   * pads powering up) causes a bounded number of scans.
+   *
+   * While both the window and the interval are 0, requests are forwarded
+   * immediately on the calling thread.
+   */
+  class CScanDebouncer : protected P8PLATFORM::CThread
+  {
+  public:
+    CScanDebouncer(void);
+    virtual ~CScanDebouncer(void) { Stop(); }
+
+    void SetScanner(IScannerCallback* scanner);
+
+    /*!
+     * \brief Set the debounce window and the minimum time between scans
+     */
+    void Configure(unsigned int windowMs, unsigned int minIntervalMs);
+
+    /*!
+     * \brief Stop the debounce thread. A pending request is issued when the
+     *        thread is restarted.
+     */
+    void Stop(void);
+
+    /*!
+     * \brief Request a scan
+     */
+    void Trigger(void);
+
+    /*!
+     * \brief Log the number of requests received and scans issued
+     */
+    void LogStatistics(void) const;
+
+  protected:
+    // implementation of CThread
+    virtual void* Process(void) override;
+
+  private:
+    IScannerCallback*          m_scanner;
+    unsigned int               m_windowMs;
+    unsigned int               m_minIntervalMs;
+    bool                       m_bPending;
+    int64_t                    m_deadlineMs;
+    int64_t                    m_lastScanMs;
+    mutable P8PLATFORM::CMutex m_mutex;
+    P8PLATFORM::CEvent         m_event;
+
+    // Statistics
+    uint64_t                   m_triggerCount;
+    uint64_t                   m_scanCount;
+  };
+}
@@ -0,0 +1,207 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ */
+
+#include "ScanPool.h"
+#include "log/Log.h"
+
+using namespace JOYSTICK;
+using namespace P8PLATFORM;
+
+// --- CScanWorker -------------------------------------------------------------
+
+CScanPool::CScanWorker::CScanWorker(CScanPool& pool, unsigned int participant)
+  : m_bWorkPending(false),
+    m_pool(pool),
+    m_participant(participant)
+{
+}
+
+void* CScanPool::CScanWorker::Process(void)
+{
+  while (true)
+  {
+    {
+      CLockObject lock(m_pool.m_mutex);
+      m_pool.m_workCondition.Wait(m_pool.m_mutex, m_bWorkPending);
+      m_bWorkPending = false;
+    }
+
+    if (IsStopped())
+      break;
+
+    m_pool.Work(m_participant);
+    m_pool.OnWorkerFinished();
+  }
+
+  return nullptr;
+}
+
+// --- CScanPool ---------------------------------------------------------------
+
+CScanPool::CScanPool(void)
+  : m_job(nullptr),
+    m_activeWorkers(0),
+    m_bDone(true),
+    m_batchCount(0),
+    m_jobCount(0),
+    m_stealCount(0)
+{
+}
+
+bool CScanPool::Start(unsigned int threadCount)
+{
+  Stop();
+
+  if (threadCount == 0)
+    return true;
+
+  // Participant 0 is the thread calling Run()
+  m_ranges.reset(new WorkRange[threadCount + 1]);
+  for (unsigned int i = 0; i <= threadCount; i++)
+  {
+    m_ranges[i].next = 0;
+    m_ranges[i].end = 0;
+  }
+
+  for (unsigned int i = 0; i < threadCount; i++)
+  {
+    CScanWorker* worker = new CScanWorker(*this, i + 1);
+    if (!worker->CreateThread())
+    {
+      esyslog("Failed to start joystick scan thread");
+      delete worker;
+      Stop();
+      return false;
+    }
+    m_workers.push_back(worker);
+  }
+
+  dsyslog("Started %u scan threads", threadCount);
+
+  return true;
+}
+
+void CScanPool::Stop(void)
+{
+  if (m_workers.empty())
+    return;
+
+  for (CScanWorker* worker : m_workers)
+    worker->StopThread(-1);
+
+  {
+    CLockObject lock(m_mutex);
+    for (CScanWorker* worker : m_workers)
+      worker->m_bWorkPending = true;
+    m_workCondition.Broadcast();
+  }
+
+  for (CScanWorker* worker : m_workers)
+  {
+    worker->StopThread(0);
+    delete worker;
+  }
+  m_workers.clear();
+  m_ranges.reset();
+
+  LogStatistics();
+}
+
+void CScanPool::Run(IScanJob& job, unsigned int jobCount)
+{
+  const unsigned int participantCount = ThreadCount() + 1;
+
+  if (participantCount == 1)
+  {
+    for (unsigned int i = 0; i < jobCount; i++)
+      job.Execute(i);
+    return;
+  }
+
+  {
+    CLockObject lock(m_mutex);
+
+    m_job = &job;
+
+    for (unsigned int i = 0; i < participantCount; i++)
+    {
+      m_ranges[i].next = jobCount * i / participantCount;
+      m_ranges[i].end = jobCount * (i + 1) / participantCount;
+    }
+
+    m_activeWorkers = ThreadCount();
+    m_bDone = false;
+
+    for (CScanWorker* worker : m_workers)
+      worker->m_bWorkPending = true;
+    m_workCondition.Broadcast();
+  }
+
+  Work(0);
+
+  // A participant only finishes once every index has been claimed, and it
+  // finishes the jobs that it claimed first
+  CLockObject lock(m_mutex);
+  m_doneCondition.Wait(m_mutex, m_bDone);
+  m_job = nullptr;
+
+  m_batchCount++;
+  m_jobCount += jobCount;
+}
+
+void CScanPool::Work(unsigned int participant)
+{
+  const unsigned int participantCount = ThreadCount() + 1;
+
+  for (unsigned int i = 0; i < participantCount; i++)
+  {
+    // Start with our own range, then steal from the others
+    WorkRange& range = m_ranges[(participant + i) % participantCount];
+
+    unsigned int index;
+    while ((index = range.next.fetch_add(1)) < range.end)
+    {
+      m_job->Execute(index);
+
+      if (i > 0)
+        m_stealCount++;
+    }
+  }
+}
+
+void CScanPool::OnWorkerFinished(void)
+{
+  CLockObject lock(m_mutex);
+  if (--m_activeWorkers == 0)
+  {
+    m_bDone = true;
+    m_doneCondition.Signal();
+  }
+}
+
+void CScanPool::LogStatistics(void) const
+{
+  if (m_batchCount == 0)
+    return;
+
+  dsyslog("Scan pool: %llu batches, %llu jobs, %llu stolen",
+          static_cast<unsigned long long>(m_batchCount),
+          static_cast<unsigned long long>(m_jobCount),
+          static_cast<unsigned long long>(m_stealCount.load()));
+}
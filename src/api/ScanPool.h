@@ -0,0 +1,129 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "p8-platform/threads/mutex.h"
+#include "p8-platform/threads/threads.h"
+
+#include <atomic>
+#include <memory>
+#include <stdint.h>
+#include <vector>
+
+namespace JOYSTICK
+{
+  /*!
+   * \brief A batch of independent jobs run by CScanPool
+   */
+  class IScanJob
+  {
+  public:
+    virtual ~IScanJob(void) { }
+
+    /*!
+     * \brief Run the job with the given index. Jobs of the same batch may run
+     *        concurrently, but each index runs exactly once.
+     */
+    virtual void Execute(unsigned int index) = 0;
+  };
+
+  /*!
+   * \brief Small work-stealing pool used to scan joysticks in parallel
+   *
+   * Each participant (the worker threads and the thread calling Run()) starts
+   * with a contiguous range of job indices. A participant that exhausts its
+   * range steals indices from the others, so one device stalled in read() or
+   * ioctl() only holds up the jobs that were already claimed.
+   */
+  class CScanPool
+  {
+  public:
+    CScanPool(void);
+    ~CScanPool(void) { Stop(); }
+
+    /*!
+     * \brief Start the given number of worker threads, replacing any that are
+     *        running
+     */
+    bool Start(unsigned int threadCount);
+
+    /*!
+     * \brief Stop all worker threads
+     */
+    void Stop(void);
+
+    /*!
+     * \brief Number of worker threads, or 0 if the pool isn't running
+     */
+    unsigned int ThreadCount(void) const { return static_cast<unsigned int>(m_workers.size()); }
+
+    /*!
+     * \brief Run a batch of jobs and wait for all of them to finish
+     *
+     * The calling thread takes part in the batch. Must not be called
+     * concurrently with Start(), Stop() or another call to Run().
+     */
+    void Run(IScanJob& job, unsigned int jobCount);
+
+    /*!
+     * \brief Log pool statistics
+     */
+    void LogStatistics(void) const;
+
+  private:
+    class CScanWorker : public P8PLATFORM::CThread
+    {
+    public:
+      CScanWorker(CScanPool& pool, unsigned int participant);
+      virtual ~CScanWorker(void) { }
+
+      // implementation of CThread
+      virtual void* Process(void) override;
+
+      bool m_bWorkPending; // Guarded by the pool's mutex
+
+    private:
+      CScanPool&         m_pool;
+      const unsigned int m_participant;
+    };
+
+    struct WorkRange
+    {
+      std::atomic<unsigned int> next;
+      unsigned int              end;
+    };
+
+    void Work(unsigned int participant);
+    void OnWorkerFinished(void);
+
+    std::vector<CScanWorker*>              m_workers;
+    std::unique_ptr<WorkRange[]>           m_ranges; // One per participant
+    IScanJob*                              m_job;
+    unsigned int                           m_activeWorkers;
+    bool                                   m_bDone;
+    P8PLATFORM::CMutex                     m_mutex;
+    P8PLATFORM::CCondition<bool>           m_workCondition;
+    P8PLATFORM::CCondition<bool>           m_doneCondition;
+
+    // Statistics
+    uint64_t                               m_batchCount;
+    uint64_t                               m_jobCount;
+    std::atomic<uint64_t>                  m_stealCount;
+  };
+}
@@ -0,0 +1,61 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ */
+
+#include "ScanThread.h"
+#include "JoystickManager.h"
+#include "JoystickTypes.h"
+
+using namespace JOYSTICK;
+
+CScanThread::CScanThread(CJoystickManager& manager)
+  : m_manager(manager)
+{
+}
+
+bool CScanThread::Start(void)
+{
+  if (IsRunning())
+    return true;
+
+  return CreateThread();
+}
+
+void CScanThread::Stop(void)
+{
+  // Wait for the current scan to finish
+  StopThread(0);
+
+  m_pool.Stop();
+}
+
+void CScanThread::RequestScan(void)
+{
+  m_scanEvent.Signal();
+}
+
+void* CScanThread::Process(void)
+{
+  while (!IsStopped())
+  {
+    if (m_scanEvent.Wait(THREAD_STOP_TIMEOUT_MS) && !IsStopped())
+      m_manager.PerformBackgroundScan(m_pool);
+  }
+
+  return nullptr;
+}
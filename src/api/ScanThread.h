@@ -0,0 +1,62 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "ScanPool.h"
+
+#include "p8-platform/threads/mutex.h"
+#include "p8-platform/threads/threads.h"
+
+namespace JOYSTICK
+{
+  class CJoystickManager;
+
+  /*!
+   * \brief Background thread that scans the joystick interfaces on request
+   *
+   * When a scan changes the joystick list, the new list is published and the
+   * frontend is asked to rescan, so that PerformJoystickScan() can return the
+   * finished result without blocking.
+   */
+  class CScanThread : protected P8PLATFORM::CThread
+  {
+  public:
+    CScanThread(CJoystickManager& manager);
+    virtual ~CScanThread(void) { Stop(); }
+
+    bool Start(void);
+    void Stop(void);
+    bool IsRunning(void) { return P8PLATFORM::CThread::IsRunning(); }
+
+    /*!
+     * \brief Request a scan. Requests made while a scan is running cause one
+     *        more scan when it finishes.
+     */
+    void RequestScan(void);
+
+  protected:
+    // implementation of CThread
+    virtual void* Process(void) override;
+
+  private:
+    CJoystickManager&     m_manager;
+    CScanPool             m_pool; // Scans interfaces in parallel
+    P8PLATFORM::CEvent    m_scanEvent;
+  };
+}
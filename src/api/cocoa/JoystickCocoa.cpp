@@ -21,6 +21,7 @@
 #include "JoystickCocoa.h"
 #include "api/JoystickTypes.h"
 #include "utils/CommonMacros.h"
+#include "utils/StringUtils.h"
 
 #include <assert.h>
 
@@ -55,6 +56,11 @@ bool CJoystickCocoa::Equals(const CJoystick* rhs) const
   return joystick && m_device == joystick->m_device;
 }
 
+std::string CJoystickCocoa::Identity(void) const
+{
+  return StringUtils::Format("%s:%p", Provider().c_str(), static_cast<const void*>(m_device));
+}
+
 bool CJoystickCocoa::Initialize(void)
 {
   CLockObject lock(m_mutex);
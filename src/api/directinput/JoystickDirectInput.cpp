@@ -23,6 +23,7 @@
 #include "api/JoystickTypes.h"
 #include "log/Log.h"
 #include "utils/CommonMacros.h"
+#include "utils/StringUtils.h"
 
 using namespace JOYSTICK;
 
@@ -65,6 +66,14 @@ bool CJoystickDirectInput::Equals(const CJoystick* rhs) const
   return m_deviceGuid == rhsDirectInput->m_deviceGuid;
 }
 
+std::string CJoystickDirectInput::Identity(void) const
+{
+  return StringUtils::Format("%s:%08lX-%04hX-%04hX-%02X%02X-%02X%02X%02X%02X%02X%02X", Provider().c_str(),
+                             m_deviceGuid.Data1, m_deviceGuid.Data2, m_deviceGuid.Data3,
+                             m_deviceGuid.Data4[0], m_deviceGuid.Data4[1], m_deviceGuid.Data4[2], m_deviceGuid.Data4[3],
+                             m_deviceGuid.Data4[4], m_deviceGuid.Data4[5], m_deviceGuid.Data4[6], m_deviceGuid.Data4[7]);
+}
+
 bool CJoystickDirectInput::Initialize(void)
 {
   HRESULT hr;
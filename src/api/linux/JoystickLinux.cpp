@@ -24,9 +24,11 @@
 #include "log/Log.h"
 #include "utils/CommonMacros.h"
 
+#include <algorithm>
 #include <dirent.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <limits.h>
 #include <linux/input.h>
 #include <linux/joystick.h>
 #include <sstream>
@@ -34,6 +36,7 @@
 #include <sys/ioctl.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <unistd.h>
 
 using namespace JOYSTICK;
 
@@ -43,12 +46,25 @@ using namespace JOYSTICK;
 CJoystickLinux::CJoystickLinux(int fd, const std::string& strFilename)
  : CJoystick(EJoystickInterface::LINUX),
    m_fd(fd),
-   m_strFilename(strFilename)
+   m_strFilename(strFilename),
+   m_readCount(0),
+   m_eventCount(0)
 {
 }
 
 void CJoystickLinux::Deinitialize(void)
 {
+  if (m_eventCount > 0)
+  {
+    dsyslog("Joystick \"%s\": read %llu events in %llu read() calls (%.2f calls per event)",
+            Name().c_str(),
+            static_cast<unsigned long long>(m_eventCount),
+            static_cast<unsigned long long>(m_readCount),
+            static_cast<double>(m_readCount) / m_eventCount);
+  }
+  m_readCount = 0;
+  m_eventCount = 0;
+
   close(m_fd);
   m_fd = INVALID_FD;
 }
@@ -65,46 +81,98 @@ bool CJoystickLinux::Equals(const CJoystick* rhs) const
   return m_strFilename == rhsLinux->m_strFilename;
 }
 
-bool CJoystickLinux::ScanEvents(void)
+std::string CJoystickLinux::Identity(void) const
+{
+  return Provider() + ":" + m_strFilename;
+}
+
+void CJoystickLinux::SeedState(void)
 {
   js_event joyEvent;
 
-  while (true)
+  // After opening, the driver reports the state of every button and axis as
+  // events flagged with JS_EVENT_INIT. Anything read here becomes the initial
+  // state instead of generating events.
+  while (read(m_fd, &joyEvent, sizeof(joyEvent)) == sizeof(joyEvent))
+  {
+    switch (joyEvent.type & ~JS_EVENT_INIT)
+    {
+    case JS_EVENT_BUTTON:
+      SetButtonValue(joyEvent.number, (joyEvent.value ? JOYSTICK_STATE_BUTTON_PRESSED : JOYSTICK_STATE_BUTTON_UNPRESSED));
+      break;
+    case JS_EVENT_AXIS:
+      SetAxisValue(joyEvent.number, joyEvent.value, MAX_AXIS);
+      break;
+    default:
+      break;
+    }
+  }
+}
+
+bool CJoystickLinux::ScanEvents(void)
+{
+  js_event events[32];
+
+  // Read no more than the budget, the rest is picked up by the next scan
+  const unsigned int budget = ReadBudget();
+  unsigned int remaining = budget > 0 ? budget : UINT_MAX;
+
+  while (remaining > 0)
   {
-    // Flush the driver queue
-    if (read(m_fd, &joyEvent, sizeof(joyEvent)) != sizeof(joyEvent))
+    // Flush the driver queue, as many events per syscall as will fit
+    const size_t count = std::min(remaining, static_cast<unsigned int>(ARRAY_SIZE(events)));
+    const ssize_t len = read(m_fd, events, count * sizeof(*events));
+    m_readCount++;
+
+    if (len < static_cast<ssize_t>(sizeof(*events)))
     {
-      if (errno == EAGAIN)
+      if (len < 0 && errno == ENODEV)
       {
-        // The circular driver queue holds 64 events. If compiling your own driver,
-        // you can increment this size bumping up JS_BUFF_SIZE in joystick.h
-        break;
+        SetDisconnected();
+        return false;
       }
-      else
+      else if (len < 0 && errno != EAGAIN)
       {
         esyslog("%s: failed to read joystick \"%s\" on %s - %d (%s)",
             __FUNCTION__, Name().c_str(), m_strFilename.c_str(), errno, strerror(errno));
-        break;
       }
+
+      // The circular driver queue holds 64 events. If compiling your own driver,
+      // you can increment this size bumping up JS_BUFF_SIZE in joystick.h
+      break;
     }
 
-    // The possible values of joystickEvent.type are:
-    // JS_EVENT_BUTTON    0x01    // button pressed/released
-    // JS_EVENT_AXIS      0x02    // joystick moved
-    // JS_EVENT_INIT      0x80    // (flag) initial state of device
+    const unsigned int eventCount = static_cast<unsigned int>(len / sizeof(*events));
 
-    // Ignore initial events, because they mess up the buttons
-    switch (joyEvent.type)
+    m_eventCount += eventCount;
+    remaining -= eventCount;
+
+    for (unsigned int i = 0; i < eventCount; i++)
     {
-    case JS_EVENT_BUTTON:
-      SetButtonValue(joyEvent.number, (joyEvent.value ? JOYSTICK_STATE_BUTTON_PRESSED : JOYSTICK_STATE_BUTTON_UNPRESSED));
-      break;
-    case JS_EVENT_AXIS:
-      SetAxisValue(joyEvent.number, joyEvent.value, MAX_AXIS);
-      break;
-    default:
-      break;
+      const js_event& joyEvent = events[i];
+
+      // The possible values of joystickEvent.type are:
+      // JS_EVENT_BUTTON    0x01    // button pressed/released
+      // JS_EVENT_AXIS      0x02    // joystick moved
+      // JS_EVENT_INIT      0x80    // (flag) initial state of device
+
+      // Initial events are consumed by SeedState(), ignore any that remain
+      switch (joyEvent.type)
+      {
+      case JS_EVENT_BUTTON:
+        SetButtonValue(joyEvent.number, (joyEvent.value ? JOYSTICK_STATE_BUTTON_PRESSED : JOYSTICK_STATE_BUTTON_UNPRESSED));
+        break;
+      case JS_EVENT_AXIS:
+        SetAxisValue(joyEvent.number, joyEvent.value, MAX_AXIS);
+        break;
+      default:
+        break;
+      }
     }
+
+    // A short read means the driver queue is empty
+    if (eventCount < count)
+      break;
   }
 
   return true;
@@ -35,12 +35,19 @@ namespace JOYSTICK
     // implementation of CJoystick
     virtual void Deinitialize(void) override;
     virtual bool Equals(const CJoystick* rhs) const override;
+    virtual std::string Identity(void) const override;
+    virtual int InputDescriptor(void) const override { return m_fd; }
 
   protected:
     virtual bool ScanEvents(void) override;
+    virtual void SeedState(void) override;
 
   private:
     int         m_fd;
     std::string m_strFilename;
+
+    // Statistics
+    uint64_t    m_readCount;  // read() calls made by ScanEvents(), including empty reads
+    uint64_t    m_eventCount; // Events returned by those calls
   };
 }
@@ -22,6 +22,7 @@
 #include "JoystickSDL.h"
 #include "api/JoystickTypes.h"
 #include "log/Log.h"
+#include "utils/StringUtils.h"
 
 #include <SDL2/SDL.h>
 
@@ -51,6 +52,11 @@ bool CJoystickSDL::Equals(const CJoystick* rhs) const
   return m_index == rhsSDL->m_index;
 }
 
+std::string CJoystickSDL::Identity(void) const
+{
+  return StringUtils::Format("%s:%u", Provider().c_str(), m_index);
+}
+
 bool CJoystickSDL::Initialize(void)
 {
   bool bSuccess = false;
@@ -34,6 +34,7 @@ namespace JOYSTICK
 
     // implementation of CJoystick
     virtual bool Equals(const CJoystick* rhs) const override;
+    virtual std::string Identity(void) const override;
     virtual bool Initialize(void) override;
     virtual void Deinitialize(void) override;
 
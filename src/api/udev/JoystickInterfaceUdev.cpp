@@ -20,12 +20,19 @@
 
 #include "JoystickInterfaceUdev.h"
 #include "JoystickUdev.h"
+#include "api/JoystickManager.h"
 #include "api/JoystickTypes.h"
+#include "log/Log.h"
 
+#include <errno.h>
 #include <libudev.h>
+#include <poll.h>
+#include <set>
+#include <string.h>
 #include <utility>
 
 using namespace JOYSTICK;
+using namespace P8PLATFORM;
 
 ButtonMap CJoystickInterfaceUdev::m_buttonMap = {
     std::make_pair("game.controller.default", FeatureVector{
@@ -40,7 +47,10 @@ ButtonMap CJoystickInterfaceUdev::m_buttonMap = {
 
 CJoystickInterfaceUdev::CJoystickInterfaceUdev() :
   m_udev(nullptr),
-  m_udev_mon(nullptr)
+  m_udev_mon(nullptr),
+  m_bEnumerated(false),
+  m_probeCount(0),
+  m_cacheHitCount(0)
 {
 }
 
@@ -60,6 +70,9 @@ bool CJoystickInterfaceUdev::Initialize()
   {
      udev_monitor_filter_add_match_subsystem_devtype(m_udev_mon, "input", nullptr);
      udev_monitor_enable_receiving(m_udev_mon);
+
+     if (!CreateThread())
+       esyslog("[udev]: Failed to start hotplug monitor, devices will be enumerated on every scan");
   }
 
   return true;
@@ -67,6 +80,18 @@ bool CJoystickInterfaceUdev::Initialize()
 
 void CJoystickInterfaceUdev::Deinitialize()
 {
+  StopThread(0);
+
+  {
+    CLockObject lock(m_deviceMutex);
+
+    if (m_probeCount > 0)
+      dsyslog("[udev]: Probed %u devices, %u found in cache", m_probeCount, m_cacheHitCount);
+
+    m_devices.clear();
+    m_bEnumerated = false;
+  }
+
   if (m_udev_mon)
   {
     udev_monitor_unref(m_udev_mon);
@@ -85,36 +110,187 @@ bool CJoystickInterfaceUdev::ScanForJoysticks(JoystickVector& joysticks)
   if (!m_udev)
     return false;
 
+  CLockObject lock(m_deviceMutex);
+
+  // Once enumerated, the monitor thread keeps the cache up to date
+  if (!m_bEnumerated || !IsRunning())
+  {
+    if (!EnumerateDevices())
+      return false;
+  }
+
+  for (const auto& device : m_devices)
+    joysticks.push_back(device.second);
+
+  return true;
+}
+
+bool CJoystickInterfaceUdev::EnumerateDevices(void)
+{
   struct udev_enumerate* enumerate = udev_enumerate_new(m_udev);
   if (enumerate == nullptr)
-  {
-    Deinitialize();
     return false;
-  }
 
   udev_enumerate_add_match_property(enumerate, "ID_INPUT_JOYSTICK", "1");
   udev_enumerate_scan_devices(enumerate);
 
+  std::set<dev_t> deviceNumbers;
+
   struct udev_list_entry* devs = udev_enumerate_get_list_entry(enumerate);
   for (struct udev_list_entry* item = devs; item != nullptr; item = udev_list_entry_get_next(item))
   {
      const char*         name = udev_list_entry_get_name(item);
      struct udev_device* dev = udev_device_new_from_syspath(m_udev, name);
-     const char*         devnode = udev_device_get_devnode(dev);
 
-     if (devnode != nullptr)
+     if (dev != nullptr)
      {
-       JoystickPtr joystick = JoystickPtr(new CJoystickUdev(dev, devnode));
-       joysticks.push_back(joystick);
+       if (IsEventNode(dev))
+       {
+         deviceNumbers.insert(udev_device_get_devnum(dev));
+         AddDevice(dev);
+       }
+       udev_device_unref(dev);
      }
-
-     udev_device_unref(dev);
   }
 
   udev_enumerate_unref(enumerate);
+
+  // Drop devices that have disappeared
+  for (auto it = m_devices.begin(); it != m_devices.end(); )
+  {
+    if (deviceNumbers.find(it->first) == deviceNumbers.end())
+      it = m_devices.erase(it);
+    else
+      ++it;
+  }
+
+  m_bEnumerated = true;
+
   return true;
 }
 
+bool CJoystickInterfaceUdev::IsEventNode(udev_device* dev)
+{
+  const char* sysname = udev_device_get_sysname(dev);
+  const char* devnode = udev_device_get_devnode(dev);
+
+  // Joysticks also have js* nodes, which can't be opened as evdev devices
+  return sysname != nullptr && devnode != nullptr && strncmp(sysname, "event", 5) == 0;
+}
+
+bool CJoystickInterfaceUdev::AddDevice(udev_device* dev)
+{
+  if (!IsEventNode(dev))
+    return false;
+
+  // Match known devices before opening anything
+  const CJoystickUdev::DeviceKey key = CJoystickUdev::GetDeviceKey(dev);
+
+  auto it = m_devices.find(key.deviceNumber);
+  if (it != m_devices.end())
+  {
+    if (static_cast<const CJoystickUdev*>(it->second.get())->Key() == key)
+    {
+      m_cacheHitCount++;
+      return false;
+    }
+
+    // The device number was reused by a new device
+    m_devices.erase(it);
+  }
+
+  m_probeCount++;
+
+  // The device is probed by the constructor. Devices that can't be opened
+  // aren't cached, so they are probed again by the next enumeration.
+  JoystickPtr joystick = JoystickPtr(new CJoystickUdev(dev, udev_device_get_devnode(dev)));
+  if (!joystick->Initialize())
+    return false;
+
+  m_devices[key.deviceNumber] = joystick;
+
+  return true;
+}
+
+bool CJoystickInterfaceUdev::HandleMonitorEvent(udev_device* dev)
+{
+  const char* action = udev_device_get_action(dev);
+  const char* syspath = udev_device_get_syspath(dev);
+
+  if (action == nullptr || syspath == nullptr)
+    return false;
+
+  CLockObject lock(m_deviceMutex);
+
+  if (strcmp(action, "add") == 0)
+  {
+    const char* isJoystick = udev_device_get_property_value(dev, "ID_INPUT_JOYSTICK");
+    if (isJoystick != nullptr && strcmp(isJoystick, "1") == 0)
+    {
+      if (AddDevice(dev))
+      {
+        dsyslog("[udev]: Joystick added: %s", syspath);
+        return true;
+      }
+    }
+  }
+  else if (strcmp(action, "remove") == 0)
+  {
+    if (m_devices.erase(udev_device_get_devnum(dev)) > 0)
+    {
+      dsyslog("[udev]: Joystick removed: %s", syspath);
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void* CJoystickInterfaceUdev::Process(void)
+{
+  pollfd monitorFd = { };
+  monitorFd.fd = udev_monitor_get_fd(m_udev_mon);
+  monitorFd.events = POLLIN;
+
+  while (!IsStopped())
+  {
+    const int ready = poll(&monitorFd, 1, THREAD_STOP_TIMEOUT_MS);
+    if (ready < 0)
+    {
+      if (errno == EINTR)
+        continue;
+
+      esyslog("[udev]: Failed to poll hotplug monitor: %s", strerror(errno));
+      break;
+    }
+
+    if (ready == 0)
+      continue;
+
+    // Handle every pending event before triggering a single scan
+    bool bChanged = false;
+
+    udev_device* dev;
+    while ((dev = udev_monitor_receive_device(m_udev_mon)) != nullptr)
+    {
+      if (HandleMonitorEvent(dev))
+        bChanged = true;
+      udev_device_unref(dev);
+
+      if (poll(&monitorFd, 1, 0) <= 0)
+        break;
+    }
+
+    if (bChanged)
+    {
+      CJoystickManager::Get().SetChanged(true);
+      CJoystickManager::Get().TriggerScan();
+    }
+  }
+
+  return nullptr;
+}
+
 const ButtonMap& CJoystickInterfaceUdev::GetButtonMap()
 {
   auto& dflt = m_buttonMap["game.controller.default"];
@@ -41,13 +41,29 @@
 
 #include "api/IJoystickInterface.h"
 
+#include "p8-platform/threads/mutex.h"
+#include "p8-platform/threads/threads.h"
+
+#include <map>
+#include <sys/types.h>
+
 struct udev;
 struct udev_device;
 struct udev_monitor;
 
 namespace JOYSTICK
 {
-  class CJoystickInterfaceUdev : public IJoystickInterface
+  /*!
+   * \brief Joystick interface for evdev devices discovered through udev
+   *
+   * Devices are enumerated on the first scan. Afterwards, a background thread
+   * reads the udev monitor and adds or removes only the affected devices, so
+   * that later scans return the cached joysticks without probing them again.
+   * If the monitor is unavailable, every scan enumerates devices, but only
+   * new devices are probed.
+   */
+  class CJoystickInterfaceUdev : public IJoystickInterface,
+                                 protected P8PLATFORM::CThread
   {
   public:
     CJoystickInterfaceUdev();
@@ -61,10 +77,46 @@ namespace JOYSTICK
     virtual bool ScanForJoysticks(JoystickVector& joysticks) override;
     virtual const ButtonMap& GetButtonMap() override;
 
+  protected:
+    // implementation of CThread
+    virtual void* Process(void) override;
+
   private:
+    /*!
+     * \brief Enumerate devices and update the cache to match
+     */
+    bool EnumerateDevices(void);
+
+    /*!
+     * \brief Handle an event received from the udev monitor
+     *
+     * \return true if a joystick was added or removed
+     */
+    bool HandleMonitorEvent(udev_device* dev);
+
+    /*!
+     * \brief Add a device to the cache if it's a joystick event node that
+     *        isn't already known
+     *
+     * \return true if the joystick was probed and added
+     */
+    bool AddDevice(udev_device* dev);
+
+    /*!
+     * \brief Check if a device is an evdev node that can be probed
+     */
+    static bool IsEventNode(udev_device* dev);
+
     udev*         m_udev;
     udev_monitor* m_udev_mon;
 
+    // Discovered joysticks
+    std::map<dev_t, JoystickPtr>       m_devices; // Device number -> joystick
+    bool                               m_bEnumerated;
+    unsigned int                       m_probeCount;
+    unsigned int                       m_cacheHitCount;
+    P8PLATFORM::CMutex                 m_deviceMutex;
+
     static ButtonMap m_buttonMap;
   };
 }
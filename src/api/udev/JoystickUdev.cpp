@@ -21,15 +21,19 @@
 #include "JoystickUdev.h"
 #include "api/JoystickTypes.h"
 #include "log/Log.h"
+#include "utils/CommonMacros.h"
+#include "utils/StringUtils.h"
 
 #include <algorithm>
 #include <errno.h>
 #include <fcntl.h>
 #include <libudev.h>
 #include <limits.h>
+#include <stdlib.h>
 #include <string.h>
 #include <sys/ioctl.h>
 #include <sys/stat.h>
+#include <time.h>
 #include <unistd.h>
 
 using namespace JOYSTICK;
@@ -42,6 +46,12 @@ using namespace JOYSTICK;
 #define test_bit(nr, addr) \
    (((1UL << ((nr) % (sizeof(long) * CHAR_BIT))) & ((addr)[(nr) / (sizeof(long) * CHAR_BIT)])) != 0)
 
+// Accessors for input_event::time were added in Linux 4.16
+#ifndef input_event_sec
+  #define input_event_sec   time.tv_sec
+  #define input_event_usec  time.tv_usec
+#endif
+
 // From RetroArch
 #define NBITS(x)  ((((x) - 1) / (sizeof(long) * CHAR_BIT)) + 1)
 
@@ -50,12 +60,20 @@ CJoystickUdev::CJoystickUdev(udev_device* dev, const char* path)
    m_dev(dev),
    m_path(path),
    m_deviceNumber(0),
+   m_key(GetDeviceKey(dev)),
    m_fd(INVALID_FD),
+   m_bMonotonicTime(false),
    m_bInitialized(false),
    m_effect(-1),
+   m_bDropped(false),
+   m_overflowCount(0),
+   m_axes_bind(),
+   m_hats_bind(),
    m_motors(),
    m_previousMotors()
 {
+  m_button_bind.fill(INVALID_INDEX);
+
   // Must initialize in the constructor to fill out joystick properties
   Initialize();
 }
@@ -66,21 +84,44 @@ bool CJoystickUdev::Equals(const CJoystick* rhs) const
   if (rhsUdev == nullptr)
     return false;
 
-  return m_deviceNumber == rhsUdev->m_deviceNumber;
+  return m_deviceNumber == rhsUdev->m_deviceNumber &&
+         m_key.generation == rhsUdev->m_key.generation;
+}
+
+std::string CJoystickUdev::Identity(void) const
+{
+  return StringUtils::Format("%s:%llu:%llu", Provider().c_str(),
+                             static_cast<unsigned long long>(m_deviceNumber),
+                             static_cast<unsigned long long>(m_key.generation));
+}
+
+CJoystickUdev::DeviceKey CJoystickUdev::GetDeviceKey(udev_device* dev)
+{
+  DeviceKey key;
+
+  key.deviceNumber = udev_device_get_devnum(dev);
+
+  // Set once udev has processed the device, for both enumerated devices and
+  // monitor events. Fall back to the event's sequence number.
+  const char* initialized = udev_device_get_property_value(dev, "USEC_INITIALIZED");
+  if (initialized != nullptr)
+    key.generation = strtoull(initialized, nullptr, 10);
+  else
+    key.generation = udev_device_get_seqnum(dev);
+
+  return key;
 }
 
 bool CJoystickUdev::Initialize(void)
 {
   if (!m_bInitialized)
   {
-    if (!OpenJoystick())
-      return false;
-
-    if (!GetProperties())
-      return false;
-
-    if (!CJoystick::Initialize())
+    // Close the device on failure so that a later retry doesn't leak it
+    if (!OpenJoystick() || !GetProperties() || !CJoystick::Initialize())
+    {
+      Deinitialize();
       return false;
+    }
 
     m_bInitialized = true;
   }
@@ -90,6 +131,14 @@ bool CJoystickUdev::Initialize(void)
 
 void CJoystickUdev::Deinitialize(void)
 {
+  if (m_overflowCount > 0)
+  {
+    dsyslog("[udev]: Event buffer for \"%s\" overflowed %u times", Name().c_str(), m_overflowCount);
+    m_overflowCount = 0;
+  }
+
+  m_bDropped = false;
+
   if (m_fd >= 0)
   {
     close(m_fd);
@@ -191,47 +240,60 @@ bool CJoystickUdev::ScanEvents(void)
   if (m_fd < 0)
     return false;
 
-  int len;
-  while ((len = read(m_fd, events, sizeof(events))) > 0)
+  // Read no more than the budget, the rest is picked up by the next scan
+  const unsigned int budget = ReadBudget();
+  unsigned int remaining = budget > 0 ? budget : UINT_MAX;
+
+  int len = 0;
+  while (remaining > 0)
   {
+    const size_t count = std::min(remaining, static_cast<unsigned int>(ARRAY_SIZE(events)));
+    if ((len = read(m_fd, events, count * sizeof(*events))) <= 0)
+      break;
+
     len /= sizeof(*events);
+    remaining -= len;
     for (unsigned int i = 0; i < static_cast<unsigned int>(len); i++)
     {
       const input_event& event = events[i];
 
+      if (m_bMonotonicTime)
+        SetInputTime(static_cast<int64_t>(event.input_event_sec) * 1000000 + event.input_event_usec);
+
       int code = event.code;
 
+      // The kernel's buffer overflowed. Events up to the next SYN_REPORT are
+      // incomplete, so discard them and read the device state instead.
+      if (event.type == EV_SYN && code == SYN_DROPPED)
+      {
+        if (m_overflowCount++ == 0)
+          isyslog("[udev]: Event buffer for \"%s\" overflowed, resyncing state", Name().c_str());
+        m_bDropped = true;
+        continue;
+      }
+
+      if (m_bDropped)
+      {
+        if (event.type == EV_SYN && code == SYN_REPORT)
+        {
+          m_bDropped = false;
+          SyncState();
+        }
+        continue;
+      }
+
       switch (event.type)
       {
         case EV_KEY:
         {
-          if (code >= BTN_MISC || (code >= KEY_UP && code <= KEY_DOWN))
-          {
-            auto it = m_button_bind.find(code);
-            if (it != m_button_bind.end())
-            {
-              const unsigned int buttonIndex = it->second;
-              SetButtonValue(buttonIndex, event.value ? JOYSTICK_STATE_BUTTON_PRESSED : JOYSTICK_STATE_BUTTON_UNPRESSED);
-            }
-          }
+          // Unbound keycodes hold INVALID_INDEX
+          if (code < KEY_CNT && m_button_bind[code] != INVALID_INDEX)
+            SetButtonValue(m_button_bind[code], event.value ? JOYSTICK_STATE_BUTTON_PRESSED : JOYSTICK_STATE_BUTTON_UNPRESSED);
           break;
         }
         case EV_ABS:
         {
-          if (code < ABS_MISC)
-          {
-            auto it = m_axes_bind.find(code);
-            if (it != m_axes_bind.end())
-            {
-              const unsigned int axisIndex = it->second.axisIndex;
-              const input_absinfo& info = it->second.axisInfo;
-
-              if (event.value >= 0)
-                SetAxisValue(axisIndex, event.value, info.maximum);
-              else
-                SetAxisValue(axisIndex, event.value, -info.minimum);
-            }
-          }
+          SetAbsValue(code, event.value);
           break;
         }
         default:
@@ -240,6 +302,13 @@ bool CJoystickUdev::ScanEvents(void)
     }
   }
 
+  // The device has been unplugged
+  if (remaining > 0 && len < 0 && errno == ENODEV)
+  {
+    SetDisconnected();
+    return false;
+  }
+
   return true;
 }
 
@@ -261,6 +330,14 @@ bool CJoystickUdev::OpenJoystick()
   if (!test_bit(EV_KEY, evbit))
     return false;
 
+#if defined(EVIOCSCLOCKID)
+  // Timestamp events on the same clock used to measure delivery latency
+  int clockId = CLOCK_MONOTONIC;
+  m_bMonotonicTime = (ioctl(m_fd, EVIOCSCLOCKID, &clockId) == 0);
+  if (!m_bMonotonicTime)
+    dsyslog("[udev]: Failed to set clock for %s, using read time for latency - %s", m_path.c_str(), strerror(errno));
+#endif
+
   return true;
 }
 
@@ -306,6 +383,7 @@ bool CJoystickUdev::GetProperties()
   // Go through all possible keycodes, check if they are used, and map them to
   // button/axes/hat indices
   unsigned int buttons = 0;
+  m_button_bind.fill(INVALID_INDEX);
   for (unsigned int i = KEY_UP; i <= KEY_DOWN; i++)
   {
     if (test_bit(i, keybit))
@@ -316,11 +394,25 @@ bool CJoystickUdev::GetProperties()
     if (test_bit(i, keybit))
       m_button_bind[i] = buttons++;
   }
-  SetButtonCount(m_button_bind.size());
+  SetButtonCount(buttons);
+
+  // Hats are bound as pairs of ABS_HATnX and ABS_HATnY codes
+  unsigned int hats = 0;
+  m_hats_bind.fill(Hat());
+  for (unsigned int i = 0; i < HAT_COUNT; i++)
+  {
+    if (test_bit(ABS_HAT0X + 2 * i, absbit) || test_bit(ABS_HAT0Y + 2 * i, absbit))
+      m_hats_bind[i].hatIndex = hats++;
+  }
+  SetHatCount(hats);
 
   unsigned int axes = 0;
+  m_axes_bind.fill(Axis());
   for (unsigned i = 0; i < ABS_MISC; i++)
   {
+    if (ABS_HAT0X <= i && i <= ABS_HAT3Y)
+      continue;
+
     if (test_bit(i, absbit))
     {
       input_absinfo abs;
@@ -328,10 +420,17 @@ bool CJoystickUdev::GetProperties()
         continue;
 
       if (abs.maximum > abs.minimum)
-        m_axes_bind[i] = { axes++, abs };
+      {
+        // Precompute the normalization done by CJoystick::SetAxisValue()
+        Axis& axis = m_axes_bind[i];
+        axis.axisIndex = axes++;
+        axis.positiveScale = abs.maximum != 0 ? 1.0f / abs.maximum : 0.0f;
+        axis.negativeScale = abs.minimum != 0 ? 1.0f / -abs.minimum : 0.0f;
+        axis.axisInfo = abs;
+      }
     }
   }
-  SetAxisCount(m_axes_bind.size());
+  SetAxisCount(axes);
 
   // Check for rumble features
   if (ioctl(m_fd, EVIOCGBIT(EV_FF, sizeof(ffbit)), ffbit) >= 0)
@@ -344,6 +443,84 @@ bool CJoystickUdev::GetProperties()
   return true;
 }
 
+void CJoystickUdev::SetAbsValue(unsigned int code, int value)
+{
+  if (ABS_HAT0X <= code && code <= ABS_HAT3Y)
+  {
+    Hat& hat = m_hats_bind[(code - ABS_HAT0X) / 2];
+    if (hat.hatIndex != INVALID_INDEX)
+    {
+      // Hat switches are reported as -1, 0 or 1 on each axis
+      const int direction = (value > 0) - (value < 0);
+      if ((code - ABS_HAT0X) % 2 == 0)
+        hat.x = direction;
+      else
+        hat.y = direction;
+
+      SetHatValue(hat.hatIndex, GetHatState(hat));
+    }
+  }
+  else if (code < ABS_CNT && m_axes_bind[code].axisIndex != INVALID_INDEX)
+  {
+    const Axis& axis = m_axes_bind[code];
+    SetAxisValue(axis.axisIndex, value * (value >= 0 ? axis.positiveScale : axis.negativeScale));
+  }
+}
+
+bool CJoystickUdev::SyncState(void)
+{
+  unsigned long keystate[NBITS(KEY_MAX)] = { };
+
+  if (ioctl(m_fd, EVIOCGKEY(sizeof(keystate)), keystate) < 0)
+  {
+    esyslog("[udev]: Failed to read button state of \"%s\" - %s", Name().c_str(), strerror(errno));
+    return false;
+  }
+
+  for (unsigned int i = 0; i < KEY_CNT; i++)
+  {
+    if (m_button_bind[i] != INVALID_INDEX)
+      SetButtonValue(m_button_bind[i], test_bit(i, keystate) ? JOYSTICK_STATE_BUTTON_PRESSED : JOYSTICK_STATE_BUTTON_UNPRESSED);
+  }
+
+  for (unsigned int i = 0; i < ABS_CNT; i++)
+  {
+    bool bBound;
+    if (ABS_HAT0X <= i && i <= ABS_HAT3Y)
+      bBound = (m_hats_bind[(i - ABS_HAT0X) / 2].hatIndex != INVALID_INDEX);
+    else
+      bBound = (m_axes_bind[i].axisIndex != INVALID_INDEX);
+
+    if (!bBound)
+      continue;
+
+    input_absinfo abs;
+    if (ioctl(m_fd, EVIOCGABS(i), &abs) < 0)
+      continue;
+
+    SetAbsValue(i, abs.value);
+  }
+
+  return true;
+}
+
+JOYSTICK_STATE_HAT CJoystickUdev::GetHatState(const Hat& hat)
+{
+  int state = JOYSTICK_STATE_HAT_UNPRESSED;
+
+  if (hat.x < 0)
+    state |= JOYSTICK_STATE_HAT_LEFT;
+  else if (hat.x > 0)
+    state |= JOYSTICK_STATE_HAT_RIGHT;
+
+  if (hat.y < 0)
+    state |= JOYSTICK_STATE_HAT_UP;
+  else if (hat.y > 0)
+    state |= JOYSTICK_STATE_HAT_DOWN;
+
+  return static_cast<JOYSTICK_STATE_HAT>(state);
+}
+
 bool CJoystickUdev::SetMotor(unsigned int motorIndex, float magnitude)
 {
   using namespace P8PLATFORM;
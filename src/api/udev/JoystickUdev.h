@@ -66,39 +66,96 @@ namespace JOYSTICK
 
     // implementation of CJoystick
     virtual bool Equals(const CJoystick* rhs) const override;
+    virtual std::string Identity(void) const override;
     virtual bool Initialize(void) override;
     virtual void Deinitialize(void) override;
     virtual void ProcessEvents(void) override;
+    virtual int InputDescriptor(void) const override { return m_fd; }
+
+    /*!
+     * \brief Identifies a device node across replugs
+     *
+     * Device numbers are reused when a device is replaced, so the node is
+     * identified by its device number and the time that udev initialized it.
+     * Both are read from udev, without opening the device.
+     */
+    struct DeviceKey
+    {
+      dev_t    deviceNumber = 0;
+      uint64_t generation = 0;
+
+      bool operator==(const DeviceKey& rhs) const { return deviceNumber == rhs.deviceNumber && generation == rhs.generation; }
+    };
+
+    static DeviceKey GetDeviceKey(udev_device* dev);
+
+    const DeviceKey& Key(void) const { return m_key; }
 
   protected:
     // implementation of CJoystick
     virtual bool ScanEvents(void) override;
+    virtual void SeedState(void) override { SyncState(); }
     bool SetMotor(unsigned int motorIndex, float magnitude);
 
   private:
     void UpdateMotorState(const std::array<uint16_t, MOTOR_COUNT>& motors);
     void Play(bool bPlayStop);
 
+    enum
+    {
+      INVALID_INDEX = 0xffff,
+      HAT_COUNT     = (ABS_HAT3Y - ABS_HAT0X) / 2 + 1, // ABS_HAT0X through ABS_HAT3Y
+    };
+
     struct Axis
     {
-      unsigned int  axisIndex;
-      input_absinfo axisInfo;
+      uint16_t      axisIndex = INVALID_INDEX;
+      float         positiveScale = 0.0f; // Multiplier for values above 0
+      float         negativeScale = 0.0f; // Multiplier for values below 0
+      input_absinfo axisInfo = { };
+    };
+
+    struct Hat
+    {
+      uint16_t hatIndex = INVALID_INDEX;
+      int      x = 0; // -1 (left), 0 or 1 (right)
+      int      y = 0; // -1 (up), 0 or 1 (down)
     };
 
+    static JOYSTICK_STATE_HAT GetHatState(const Hat& hat);
+
     bool OpenJoystick();
     bool GetProperties();
 
+    /*!
+     * \brief Apply the value of an absolute axis or hat code
+     */
+    void SetAbsValue(unsigned int code, int value);
+
+    /*!
+     * \brief Read the state of all buttons, hats and axes from the device
+     *
+     * Used to seed the initial state, and to recover after the kernel dropped
+     * events because its buffer overflowed (SYN_DROPPED).
+     */
+    bool SyncState(void);
+
     // Udev properties
     udev_device* m_dev;
     std::string  m_path;
     dev_t        m_deviceNumber;
+    DeviceKey    m_key;
     int          m_fd;
+    bool         m_bMonotonicTime; // Event timestamps use CLOCK_MONOTONIC
     bool         m_bInitialized;
     int          m_effect;
+    bool         m_bDropped; // Discarding events until the next SYN_REPORT
+    unsigned int m_overflowCount;
 
     // Joystick properties
-    std::map<unsigned int, unsigned int> m_button_bind; // Maps keycodes -> button
-    std::map<unsigned int, Axis>         m_axes_bind;   // Maps keycodes -> axis and axis info
+    std::array<uint16_t, KEY_CNT>        m_button_bind; // Maps keycodes -> button, or INVALID_INDEX
+    std::array<Axis, ABS_CNT>            m_axes_bind;   // Maps axis codes -> axis and axis info
+    std::array<Hat, HAT_COUNT>           m_hats_bind;   // Maps (code - ABS_HAT0X) / 2 -> hat and hat state
     std::array<uint16_t, MOTOR_COUNT>    m_motors;
     std::array<uint16_t, MOTOR_COUNT>    m_previousMotors;
     P8PLATFORM::CMutex                   m_mutex;
@@ -22,6 +22,7 @@
 #include "JoystickInterfaceXInput.h"
 #include "XInputDLL.h"
 #include "api/JoystickTypes.h"
+#include "utils/StringUtils.h"
 
 #include <Xinput.h>
 
@@ -65,6 +66,11 @@ bool CJoystickXInput::Equals(const CJoystick* rhs) const
   return m_controllerID == rhsXInput->m_controllerID;
 }
 
+std::string CJoystickXInput::Identity(void) const
+{
+  return StringUtils::Format("%s:%u", Provider().c_str(), m_controllerID);
+}
+
 void CJoystickXInput::PowerOff()
 {
   if (CXInputDLL::Get().Version() == "1.3")
@@ -39,6 +39,7 @@ namespace JOYSTICK
     virtual ~CJoystickXInput(void) { }
 
     virtual bool Equals(const CJoystick* rhs) const override;
+    virtual std::string Identity(void) const override;
 
     virtual void PowerOff() override;
 
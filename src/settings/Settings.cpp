@@ -32,10 +32,28 @@ using namespace JOYSTICK;
 #define SETTING_OSX_DRIVER          "driver_osx"
 #define SETTING_XINPUT_DRIVER       "driver_xinput"
 #define SETTING_DIRECTINPUT_DRIVER  "driver_directinput"
+#define SETTING_INPUT_THREAD        "input_thread"
+#define SETTING_AXIS_THRESHOLD      "axis_threshold"
+#define SETTING_AXIS_KEEPALIVE      "axis_keepalive"
+#define SETTING_ORDERED_EVENTS      "ordered_events"
+#define SETTING_SCAN_THREADS        "scan_threads"
+#define SETTING_ASYNC_SCAN          "async_scan"
+#define SETTING_SCAN_DEBOUNCE       "scan_debounce"
+#define SETTING_SCAN_INTERVAL       "scan_interval"
+#define SETTING_READ_BUDGET         "read_budget"
 
 CSettings::CSettings(void)
   : m_bInitialized(false),
-    m_bGenerateRetroArchConfigs(false)
+    m_bGenerateRetroArchConfigs(false),
+    m_bUseInputThread(false),
+    m_axisThreshold(0.0f),
+    m_axisKeepAliveMs(0),
+    m_bUseOrderedEvents(false),
+    m_scanThreads(0),
+    m_bUseAsyncScan(false),
+    m_scanDebounceMs(0),
+    m_scanIntervalMs(0),
+    m_readBudget(0)
 {
 }
 
@@ -109,6 +127,61 @@ void CSettings::SetSetting(const std::string& strName, const void* value)
     CJoystickManager::Get().SetEnabled(iface, *static_cast<const bool*>(value));
     CJoystickManager::Get().TriggerScan();
   }
+  else if (strName == SETTING_INPUT_THREAD)
+  {
+    m_bUseInputThread = *static_cast<const bool*>(value);
+    dsyslog("Setting \"%s\" set to %s", SETTING_INPUT_THREAD, m_bUseInputThread ? "true" : "false");
+    CJoystickManager::Get().SetInputThread(m_bUseInputThread);
+  }
+  else if (strName == SETTING_AXIS_THRESHOLD)
+  {
+    m_axisThreshold = *static_cast<const float*>(value);
+    dsyslog("Setting \"%s\" set to %f", SETTING_AXIS_THRESHOLD, m_axisThreshold);
+  }
+  else if (strName == SETTING_AXIS_KEEPALIVE)
+  {
+    const int keepAliveMs = *static_cast<const int*>(value);
+    m_axisKeepAliveMs = keepAliveMs > 0 ? keepAliveMs : 0;
+    dsyslog("Setting \"%s\" set to %u ms", SETTING_AXIS_KEEPALIVE, m_axisKeepAliveMs);
+  }
+  else if (strName == SETTING_ORDERED_EVENTS)
+  {
+    m_bUseOrderedEvents = *static_cast<const bool*>(value);
+    dsyslog("Setting \"%s\" set to %s", SETTING_ORDERED_EVENTS, m_bUseOrderedEvents ? "true" : "false");
+  }
+  else if (strName == SETTING_SCAN_THREADS)
+  {
+    const int scanThreads = *static_cast<const int*>(value);
+    m_scanThreads = scanThreads > 0 ? scanThreads : 0;
+    dsyslog("Setting \"%s\" set to %u", SETTING_SCAN_THREADS, m_scanThreads);
+    CJoystickManager::Get().SetScanThreads(m_scanThreads);
+  }
+  else if (strName == SETTING_ASYNC_SCAN)
+  {
+    m_bUseAsyncScan = *static_cast<const bool*>(value);
+    dsyslog("Setting \"%s\" set to %s", SETTING_ASYNC_SCAN, m_bUseAsyncScan ? "true" : "false");
+    CJoystickManager::Get().SetAsyncScan(m_bUseAsyncScan);
+  }
+  else if (strName == SETTING_SCAN_DEBOUNCE)
+  {
+    const int debounceMs = *static_cast<const int*>(value);
+    m_scanDebounceMs = debounceMs > 0 ? debounceMs : 0;
+    dsyslog("Setting \"%s\" set to %u ms", SETTING_SCAN_DEBOUNCE, m_scanDebounceMs);
+    CJoystickManager::Get().SetScanDebounce(m_scanDebounceMs, m_scanIntervalMs);
+  }
+  else if (strName == SETTING_SCAN_INTERVAL)
+  {
+    const int intervalMs = *static_cast<const int*>(value);
+    m_scanIntervalMs = intervalMs > 0 ? intervalMs : 0;
+    dsyslog("Setting \"%s\" set to %u ms", SETTING_SCAN_INTERVAL, m_scanIntervalMs);
+    CJoystickManager::Get().SetScanDebounce(m_scanDebounceMs, m_scanIntervalMs);
+  }
+  else if (strName == SETTING_READ_BUDGET)
+  {
+    const int readBudget = *static_cast<const int*>(value);
+    m_readBudget = readBudget > 0 ? readBudget : 0;
+    dsyslog("Setting \"%s\" set to %u", SETTING_READ_BUDGET, m_readBudget);
+  }
 
   m_bInitialized = true;
 }
@@ -48,8 +48,41 @@ namespace JOYSTICK
      */
     bool GenerateRetroArchConfigs(void) const { return m_bGenerateRetroArchConfigs; }
 
+    /*!
+     * \brief Minimum change in an axis's value that produces an event, or 0
+     *        to use the built-in default
+     */
+    float AxisThreshold(void) const { return m_axisThreshold; }
+
+    /*!
+     * \brief Interval at which unchanged axes are sent again, or 0 to only send
+     *        axes when they change
+     */
+    unsigned int AxisKeepAliveMs(void) const { return m_axisKeepAliveMs; }
+
+    /*!
+     * \brief Emit every transition in the order it occurred, instead of only
+     *        the latest state of each button, hat and axis
+     */
+    bool UseOrderedEvents(void) const { return m_bUseOrderedEvents; }
+
+    /*!
+     * \brief Maximum number of events read from a joystick per poll, or 0 for
+     *        no limit
+     */
+    unsigned int ReadBudget(void) const { return m_readBudget; }
+
   private:
-    bool        m_bInitialized;
-    bool        m_bGenerateRetroArchConfigs;
+    bool         m_bInitialized;
+    bool         m_bGenerateRetroArchConfigs;
+    bool         m_bUseInputThread;
+    float        m_axisThreshold;
+    unsigned int m_axisKeepAliveMs;
+    bool         m_bUseOrderedEvents;
+    unsigned int m_scanThreads;
+    bool         m_bUseAsyncScan;
+    unsigned int m_scanDebounceMs;
+    unsigned int m_scanIntervalMs;
+    unsigned int m_readBudget;
   };
 }
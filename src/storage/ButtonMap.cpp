@@ -23,6 +23,7 @@
 #include "DeviceConfiguration.h"
 #include "StorageManager.h"
 #include "StorageUtils.h"
+#include "api/JoystickManager.h"
 #include "buttonmapper/ButtonMapUtils.h"
 #include "log/Log.h"
 
@@ -61,6 +62,15 @@ const ButtonMap& CButtonMap::GetButtonMap()
   if (!m_bModified)
     Refresh();
 
+  // Transfer axis configs from device configuration to features' primitives.
+  // This is repeated on every call, as the primitives depend on the trigger
+  // calibration that connected joysticks apply.
+  TriggerPropertiesMap appliedTriggers;
+  CJoystickManager::Get().GetAppliedTriggers(*m_device, appliedTriggers);
+
+  for (auto it = m_buttonMap.begin(); it != m_buttonMap.end(); ++it)
+    m_device->Configuration().GetAxisConfigs(it->second, appliedTriggers);
+
   return m_buttonMap;
 }
 
@@ -71,7 +81,9 @@ void CButtonMap::MapFeatures(const std::string& controllerId, const FeatureVecto
     m_originalButtonMap = m_buttonMap;
 
   // Update axis configurations
-  m_device->Configuration().SetAxisConfigs(features);
+  TriggerPropertiesMap appliedTriggers;
+  CJoystickManager::Get().GetAppliedTriggers(*m_device, appliedTriggers);
+  m_device->Configuration().SetAxisConfigs(features, appliedTriggers);
 
   // Merge new features
   FeatureVector& myFeatures = m_buttonMap[controllerId];
@@ -136,12 +148,7 @@ bool CButtonMap::Refresh(void)
       return false;
 
     for (auto it = m_buttonMap.begin(); it != m_buttonMap.end(); ++it)
-    {
-      // Transfer axis configs from device configuration to features' primitives
-      m_device->Configuration().GetAxisConfigs(it->second);
-
       Sanitize(it->second, it->first);
-    }
 
     m_timestamp = now;
     m_originalButtonMap.clear();
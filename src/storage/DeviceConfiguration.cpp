@@ -81,47 +81,70 @@ PrimitiveVector CDeviceConfiguration::GetIgnoredPrimitives() const
   return primitives;
 }
 
-void CDeviceConfiguration::GetAxisConfigs(FeatureVector& features) const
+void CDeviceConfiguration::GetAxisConfigs(FeatureVector& features,
+                                          const TriggerPropertiesMap& appliedTriggers) const
 {
   for (auto& feature : features)
   {
     for (auto& primitive : feature.Primitives())
-      GetAxisConfig(primitive);
+      GetAxisConfig(primitive, appliedTriggers);
   }
 }
 
-void CDeviceConfiguration::GetAxisConfig(ADDON::DriverPrimitive& primitive) const
+void CDeviceConfiguration::GetAxisConfig(ADDON::DriverPrimitive& primitive,
+                                         const TriggerPropertiesMap& appliedTriggers) const
 {
   if (primitive.Type() == JOYSTICK_DRIVER_PRIMITIVE_TYPE_SEMIAXIS)
   {
     auto it = m_axes.find(primitive.DriverIndex());
     if (it != m_axes.end())
     {
-      const AxisConfiguration& config = it->second;
+      // If the add-on calibrates the axis, the frontend sees a calibrated
+      // axis centered at 0. Otherwise it calibrates the raw axis itself.
+      TriggerProperties trigger = it->second.trigger;
+      if (appliedTriggers.find(primitive.DriverIndex()) != appliedTriggers.end())
+        trigger.Reset();
+
       primitive = ADDON::DriverPrimitive(primitive.DriverIndex(),
-                                         config.trigger.center,
+                                         trigger.center,
                                          primitive.SemiAxisDirection(),
-                                         config.trigger.range);
+                                         trigger.range);
     }
   }
 }
 
-void CDeviceConfiguration::SetAxisConfigs(const FeatureVector& features)
+void CDeviceConfiguration::SetAxisConfigs(const FeatureVector& features,
+                                          const TriggerPropertiesMap& appliedTriggers)
 {
   for (const auto& feature : features)
   {
     for (const auto& primitive : feature.Primitives())
-      SetAxisConfig(primitive);
+      SetAxisConfig(primitive, appliedTriggers);
   }
 }
 
-void CDeviceConfiguration::SetAxisConfig(const ADDON::DriverPrimitive& primitive)
+void CDeviceConfiguration::SetAxisConfig(const ADDON::DriverPrimitive& primitive,
+                                         const TriggerPropertiesMap& appliedTriggers)
 {
   if (primitive.Type() == JOYSTICK_DRIVER_PRIMITIVE_TYPE_SEMIAXIS)
   {
-    AxisConfiguration& config = m_axes[primitive.DriverIndex()];
-    config.trigger.center = primitive.Center();
-    config.trigger.range = primitive.Range();
+    TriggerProperties trigger;
+    trigger.center = primitive.Center();
+    trigger.range = primitive.Range();
+
+    // The frontend measures the trigger from the events it receives. If the
+    // add-on calibrated them, compose the measurement with that calibration
+    // so the stored trigger stays relative to the raw axis. A default
+    // measurement then keeps the calibration, and any other corrects it.
+    auto it = appliedTriggers.find(primitive.DriverIndex());
+    if (it != appliedTriggers.end())
+    {
+      const TriggerProperties& applied = it->second;
+      trigger.center = applied.center + trigger.center * static_cast<int>(applied.range);
+      trigger.range = applied.range * trigger.range;
+    }
+
+    m_axes[primitive.DriverIndex()].trigger = trigger;
   }
 }
 
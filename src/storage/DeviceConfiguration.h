@@ -46,13 +46,16 @@ namespace JOYSTICK
     const ButtonConfigurationMap& Buttons(void) const              { return m_buttons; }
     const ButtonConfiguration&    Button(unsigned int index) const;
     PrimitiveVector               GetIgnoredPrimitives() const;
-    void                          GetAxisConfigs(FeatureVector& features) const;
-    void                          GetAxisConfig(ADDON::DriverPrimitive& primitive) const;
+    void                          GetAxisConfigs(FeatureVector& features,
+                                                 const TriggerPropertiesMap& appliedTriggers) const;
+    void                          GetAxisConfig(ADDON::DriverPrimitive& primitive,
+                                                const TriggerPropertiesMap& appliedTriggers) const;
 
     void SetAxis(unsigned int index, const AxisConfiguration& config)     { m_axes[index] = config; }
     void SetButton(unsigned int index, const ButtonConfiguration& config) { m_buttons[index] = config; }
-    void SetAxisConfigs(const FeatureVector& features);
-    void SetAxisConfig(const ADDON::DriverPrimitive& primitive);
+    void SetAxisConfigs(const FeatureVector& features, const TriggerPropertiesMap& appliedTriggers);
+    void SetAxisConfig(const ADDON::DriverPrimitive& primitive,
+                       const TriggerPropertiesMap& appliedTriggers);
     void SetIgnoredPrimitives(const PrimitiveVector& primitives);
 
   private:
@@ -32,6 +32,7 @@ namespace ADDON
 namespace JOYSTICK
 {
   class CDevice;
+  class CDeviceConfiguration;
 
   class IDatabaseCallbacks
   {
@@ -72,6 +73,11 @@ namespace JOYSTICK
      */
     virtual bool SetIgnoredPrimitives(const ADDON::Joystick& driverInfo, const PrimitiveVector& primitives) = 0;
 
+    /*!
+     * \copydoc CStorageManager::GetDeviceConfiguration()
+     */
+    virtual bool GetDeviceConfiguration(const ADDON::Joystick& driverInfo, CDeviceConfiguration& configuration) = 0;
+
     /*!
      * \copydoc CStorageManager::SaveButtonMap()
      */
@@ -145,6 +145,18 @@ void CResources::SetIgnoredPrimitives(const CDevice& deviceInfo, const Primitive
   }
 }
 
+bool CResources::GetDeviceConfiguration(const CDevice& deviceInfo, CDeviceConfiguration& configuration) const
+{
+  DevicePtr device = GetDevice(deviceInfo);
+  if (device)
+  {
+    configuration = device->Configuration();
+    return true;
+  }
+
+  return false;
+}
+
 void CResources::Revert(const CDevice& deviceInfo)
 {
   CButtonMap* resource = GetResource(deviceInfo, false);
@@ -243,6 +255,16 @@ bool CJustABunchOfFiles::SetIgnoredPrimitives(const ADDON::Joystick& driverInfo,
   return true;
 }
 
+bool CJustABunchOfFiles::GetDeviceConfiguration(const ADDON::Joystick& driverInfo, CDeviceConfiguration& configuration)
+{
+  CLockObject lock(m_mutex);
+
+  // Update index
+  IndexDirectory(m_strResourcePath, FOLDER_DEPTH);
+
+  return m_resources.GetDeviceConfiguration(driverInfo, configuration);
+}
+
 bool CJustABunchOfFiles::SaveButtonMap(const ADDON::Joystick& driverInfo)
 {
   if (!m_bReadWrite)
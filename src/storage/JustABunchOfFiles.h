@@ -52,6 +52,8 @@ namespace JOYSTICK
     bool GetIgnoredPrimitives(const CDevice& deviceInfo, PrimitiveVector& primitives) const;
     void SetIgnoredPrimitives(const CDevice& deviceInfo, const PrimitiveVector& primitives);
 
+    bool GetDeviceConfiguration(const CDevice& deviceInfo, CDeviceConfiguration& configuration) const;
+
     void Revert(const CDevice& deviceInfo);
 
   private:
@@ -85,6 +87,7 @@ namespace JOYSTICK
                              const FeatureVector& features) override;
     virtual bool GetIgnoredPrimitives(const ADDON::Joystick& driverInfo, PrimitiveVector& primitives) override;
     virtual bool SetIgnoredPrimitives(const ADDON::Joystick& driverInfo, const PrimitiveVector& primitives) override;
+    virtual bool GetDeviceConfiguration(const ADDON::Joystick& driverInfo, CDeviceConfiguration& configuration) override;
     virtual bool SaveButtonMap(const ADDON::Joystick& driverInfo) override;
     virtual bool RevertButtonMap(const ADDON::Joystick& driverInfo) override;
     virtual bool ResetButtonMap(const ADDON::Joystick& driverInfo,
@@ -43,14 +43,30 @@ namespace JOYSTICK
     }
   };
 
+  struct DeadzoneProperties
+  {
+    float deadzone = 0.0f; // Fraction of the axis's range treated as center
+    int   stickAxis = -1;  // Other axis of the stick for a radial deadzone, or -1 for per-axis
+
+    bool operator==(const DeadzoneProperties& other) const
+    {
+      return deadzone == other.deadzone &&
+             stickAxis == other.stickAxis;
+    }
+  };
+
   struct AxisConfiguration
   {
     TriggerProperties trigger;
+    DeadzoneProperties deadzone;
+    float threshold = 0.0f; // Minimum change in value that produces an event, or 0 for the add-on setting
     bool bIgnore = false;
 
     bool operator==(const AxisConfiguration& other) const
     {
       return trigger == other.trigger &&
+             deadzone == other.deadzone &&
+             threshold == other.threshold &&
              bIgnore == other.bIgnore;
     }
   };
@@ -66,5 +82,6 @@ namespace JOYSTICK
   };
 
   typedef std::map<unsigned int, AxisConfiguration> AxisConfigurationMap;
+  typedef std::map<unsigned int, TriggerProperties> TriggerPropertiesMap;
   typedef std::map<unsigned int, ButtonConfiguration> ButtonConfigurationMap;
 }
@@ -21,6 +21,7 @@
 #include "StorageManager.h"
 #include "JustABunchOfFiles.h"
 #include "StorageUtils.h"
+#include "api/JoystickManager.h"
 #include "buttonmapper/ButtonMapper.h"
 #include "log/Log.h"
 #include "storage/api/DatabaseJoystickAPI.h"
@@ -129,6 +130,10 @@ bool CStorageManager::MapFeatures(const ADDON::Joystick& joystick,
   for (DatabaseVector::const_iterator it = m_databases.begin(); it != m_databases.end(); ++it)
     bSuccess |= (*it)->MapFeatures(joystick, strControllerId, features);
 
+  // Mapping can calibrate triggers
+  if (bSuccess)
+    CJoystickManager::Get().ReloadConfiguration(joystick);
+
   return bSuccess;
 }
 
@@ -148,9 +153,24 @@ bool CStorageManager::SetIgnoredPrimitives(const ADDON::Joystick& joystick, cons
   for (DatabaseVector::const_iterator it = m_databases.begin(); it != m_databases.end(); ++it)
     bSuccess |= (*it)->SetIgnoredPrimitives(joystick, primitives);
 
+  // Stop reading the ignored primitives from live joysticks
+  if (bSuccess)
+    CJoystickManager::Get().ReloadConfiguration(joystick);
+
   return bSuccess;
 }
 
+bool CStorageManager::GetDeviceConfiguration(const ADDON::Joystick& joystick, CDeviceConfiguration& configuration)
+{
+  for (DatabaseVector::const_iterator it = m_databases.begin(); it != m_databases.end(); ++it)
+  {
+    if ((*it)->GetDeviceConfiguration(joystick, configuration))
+      return true;
+  }
+
+  return false;
+}
+
 bool CStorageManager::SaveButtonMap(const ADDON::Joystick& joystick)
 {
   bool bModified = false;
@@ -168,6 +188,9 @@ bool CStorageManager::RevertButtonMap(const ADDON::Joystick& joystick)
   for (DatabaseVector::const_iterator it = m_databases.begin(); it != m_databases.end(); ++it)
     bModified |= (*it)->RevertButtonMap(joystick);
 
+  // Reverting restores the ignored primitives too
+  CJoystickManager::Get().ReloadConfiguration(joystick);
+
   return bModified;
 }
 
@@ -178,6 +201,9 @@ bool CStorageManager::ResetButtonMap(const ADDON::Joystick& joystick, const std:
   for (DatabaseVector::const_iterator it = m_databases.begin(); it != m_databases.end(); ++it)
     bModified |= (*it)->ResetButtonMap(joystick, strControllerId);
 
+  // Resetting clears the device configuration
+  CJoystickManager::Get().ReloadConfiguration(joystick);
+
   return bModified;
 }
 
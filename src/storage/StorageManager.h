@@ -40,6 +40,7 @@ namespace JOYSTICK
 {
   class CButtonMapper;
   class CDevice;
+  class CDeviceConfiguration;
   class IDatabase;
 
   class CStorageManager
@@ -112,6 +113,17 @@ namespace JOYSTICK
      */
     bool SetIgnoredPrimitives(const ADDON::Joystick& joystick, const PrimitiveVector& primitives);
 
+    /*!
+     * \brief Get the stored configuration of a device, such as its axis
+     *        deadzones and ignored primitives
+     *
+     * \param joystick      The device's joystick properties; unknown values may be left at their default
+     * \param configuration The device's configuration
+     *
+     * \return true if the configuration was loaded from a storage backend
+     */
+    bool GetDeviceConfiguration(const ADDON::Joystick& joystick, CDeviceConfiguration& configuration);
+
     /*!
      * \brief Save the button map for the specified device
      *
@@ -44,6 +44,11 @@ bool CDatabaseJoystickAPI::SetIgnoredPrimitives(const ADDON::Joystick& joystick,
   return false;
 }
 
+bool CDatabaseJoystickAPI::GetDeviceConfiguration(const ADDON::Joystick& driverInfo, CDeviceConfiguration& configuration)
+{
+  return false;
+}
+
 bool CDatabaseJoystickAPI::SaveButtonMap(const ADDON::Joystick& driverInfo)
 {
   return false;
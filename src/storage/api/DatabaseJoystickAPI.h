@@ -35,6 +35,7 @@ namespace JOYSTICK
     virtual bool MapFeatures(const ADDON::Joystick& driverInfo, const std::string& controllerId, const FeatureVector& features) override;
     virtual bool GetIgnoredPrimitives(const ADDON::Joystick& driverInfo, PrimitiveVector& primitives) override;
     virtual bool SetIgnoredPrimitives(const ADDON::Joystick& driverInfo, const PrimitiveVector& primitives) override;
+    virtual bool GetDeviceConfiguration(const ADDON::Joystick& driverInfo, CDeviceConfiguration& configuration) override;
     virtual bool SaveButtonMap(const ADDON::Joystick& driverInfo) override;
     virtual bool RevertButtonMap(const ADDON::Joystick& driverInfo) override;
     virtual bool ResetButtonMap(const ADDON::Joystick& driverInfo, const std::string& controllerId) override;
@@ -57,4 +57,7 @@
 #define BUTTONMAP_XML_ATTR_DRIVER_INDEX        "index"
 #define BUTTONMAP_XML_ATTR_AXIS_CENTER         "center"
 #define BUTTONMAP_XML_ATTR_AXIS_RANGE          "range"
+#define BUTTONMAP_XML_ATTR_AXIS_DEADZONE       "deadzone"
+#define BUTTONMAP_XML_ATTR_AXIS_STICK          "stick"
+#define BUTTONMAP_XML_ATTR_AXIS_THRESHOLD      "threshold"
 #define BUTTONMAP_XML_ATTR_IGNORE              "ignore"
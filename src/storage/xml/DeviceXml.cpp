@@ -199,6 +199,16 @@ bool CDeviceXml::SerializeAxis(unsigned int index, const AxisConfiguration& axis
       axisElem->SetAttribute(BUTTONMAP_XML_ATTR_AXIS_RANGE, axisConfig.trigger.range);
     }
 
+    if (axisConfig.deadzone.deadzone > 0.0f)
+    {
+      axisElem->SetDoubleAttribute(BUTTONMAP_XML_ATTR_AXIS_DEADZONE, axisConfig.deadzone.deadzone);
+      if (axisConfig.deadzone.stickAxis >= 0)
+        axisElem->SetAttribute(BUTTONMAP_XML_ATTR_AXIS_STICK, axisConfig.deadzone.stickAxis);
+    }
+
+    if (axisConfig.threshold > 0.0f)
+      axisElem->SetDoubleAttribute(BUTTONMAP_XML_ATTR_AXIS_THRESHOLD, axisConfig.threshold);
+
     if (axisConfig.bIgnore)
       axisElem->SetAttribute(BUTTONMAP_XML_ATTR_IGNORE, "true");
   }
@@ -249,6 +259,18 @@ bool CDeviceXml::DeserializeAxis(const TiXmlElement* pElement, unsigned int& ind
   if (range)
     config.trigger.range = std::atoi(range);
 
+  const char* deadzone = pElement->Attribute(BUTTONMAP_XML_ATTR_AXIS_DEADZONE);
+  if (deadzone)
+    config.deadzone.deadzone = static_cast<float>(std::atof(deadzone));
+
+  const char* stick = pElement->Attribute(BUTTONMAP_XML_ATTR_AXIS_STICK);
+  if (stick)
+    config.deadzone.stickAxis = std::atoi(stick);
+
+  const char* threshold = pElement->Attribute(BUTTONMAP_XML_ATTR_AXIS_THRESHOLD);
+  if (threshold)
+    config.threshold = static_cast<float>(std::atof(threshold));
+
   const char* ignore = pElement->Attribute(BUTTONMAP_XML_ATTR_IGNORE);
   if (ignore)
     config.bIgnore = (std::string(ignore) == "true");
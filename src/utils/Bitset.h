@@ -0,0 +1,121 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "InlineVector.h"
+
+#include <algorithm>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace JOYSTICK
+{
+  /*!
+   * \brief Bitset sized at runtime, stored inline for up to N bits
+   */
+  template <size_t N>
+  class CBitset
+  {
+  public:
+    CBitset(void) : m_size(0) { }
+
+    /*!
+     * \brief Resize to the given number of bits, all cleared
+     */
+    void Resize(size_t size)
+    {
+      m_words.Assign((size + WORD_BITS - 1) / WORD_BITS, 0);
+      m_size = size;
+    }
+
+    size_t Size(void) const { return m_size; }
+
+    void Set(size_t index) { m_words[index / WORD_BITS] |= Mask(index); }
+    void Set(size_t index, bool bValue) { if (bValue) Set(index); else Reset(index); }
+    void Reset(size_t index) { m_words[index / WORD_BITS] &= ~Mask(index); }
+    bool Test(size_t index) const { return (m_words[index / WORD_BITS] & Mask(index)) != 0; }
+
+    /*!
+     * \brief Clear all bits
+     */
+    void ResetAll(void)
+    {
+      for (size_t i = 0; i < m_words.Size(); i++)
+        m_words[i] = 0;
+    }
+
+    /*!
+     * \brief Call func with the index of each set bit, in increasing order
+     *
+     * Runs in time proportional to the number of words plus the number of
+     * set bits, not the number of bits.
+     */
+    template <typename FUNC>
+    void ForEach(FUNC func) const
+    {
+      for (size_t i = 0; i < m_words.Size(); i++)
+      {
+        for (uint64_t word = m_words[i]; word != 0; word &= word - 1)
+          func(i * WORD_BITS + CountTrailingZeros(word));
+      }
+    }
+
+    /*!
+     * \brief Call func with the index of each bit that differs from other,
+     *        in increasing order
+     *
+     * Bits are compared a word at a time, so only differing bits are visited.
+     * Each word is compared before its bits are visited, so func may update
+     * either bitset.
+     */
+    template <typename FUNC>
+    void ForEachDifference(const CBitset& other, FUNC func) const
+    {
+      const size_t wordCount = std::min(m_words.Size(), other.m_words.Size());
+      for (size_t i = 0; i < wordCount; i++)
+      {
+        for (uint64_t word = m_words[i] ^ other.m_words[i]; word != 0; word &= word - 1)
+          func(i * WORD_BITS + CountTrailingZeros(word));
+      }
+    }
+
+  private:
+    static const size_t WORD_BITS = 64;
+
+    static uint64_t Mask(size_t index) { return static_cast<uint64_t>(1) << (index % WORD_BITS); }
+
+    static unsigned int CountTrailingZeros(uint64_t word)
+    {
+#if defined(__GNUC__)
+      return __builtin_ctzll(word);
+#else
+      unsigned int count = 0;
+      while ((word & 1) == 0)
+      {
+        word >>= 1;
+        count++;
+      }
+      return count;
+#endif
+    }
+
+    CInlineVector<uint64_t, (N + WORD_BITS - 1) / WORD_BITS> m_words;
+    size_t                                                   m_size;
+  };
+}
@@ -0,0 +1,70 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <stddef.h>
+#include <vector>
+
+namespace JOYSTICK
+{
+  /*!
+   * \brief Array whose elements are stored inline up to a fixed capacity
+   *
+   * Sized by Assign(). Up to N elements live inside the object, so typical
+   * sizes never touch the heap. Larger sizes fall back to a std::vector.
+   */
+  template <typename T, size_t N>
+  class CInlineVector
+  {
+  public:
+    CInlineVector(void) : m_inline(), m_size(0) { }
+
+    /*!
+     * \brief Resize to the given number of elements, all set to value
+     */
+    void Assign(size_t count, const T& value)
+    {
+      if (count > N)
+        m_heap.assign(count, value);
+      else
+        m_heap.clear();
+
+      m_size = count;
+
+      std::fill(Data(), Data() + m_size, value);
+    }
+
+    void Clear(void) { Assign(0, T()); }
+
+    size_t Size(void) const { return m_size; }
+
+    T* Data(void) { return m_size > N ? m_heap.data() : m_inline.data(); }
+    const T* Data(void) const { return m_size > N ? m_heap.data() : m_inline.data(); }
+
+    T& operator[](size_t index) { return Data()[index]; }
+    const T& operator[](size_t index) const { return Data()[index]; }
+
+  private:
+    std::array<T, N> m_inline;
+    std::vector<T>   m_heap;
+    size_t           m_size;
+  };
+}
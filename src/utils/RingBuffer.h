@@ -0,0 +1,101 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <atomic>
+#include <stddef.h>
+#include <vector>
+
+namespace JOYSTICK
+{
+  /*!
+   * \brief Bounded lock-free queue for exactly one producer and one consumer
+   *
+   * Storage is allocated by Reset(), so Push() and Pop() never allocate.
+   * Reset() must not be called while either side is in use.
+   */
+  template <typename T>
+  class CRingBuffer
+  {
+  public:
+    CRingBuffer(void) : m_mask(0), m_head(0), m_tail(0) { }
+
+    /*!
+     * \brief Allocate storage for at least the given number of items
+     */
+    void Reset(size_t capacity)
+    {
+      size_t size = 1;
+      while (size < capacity)
+        size <<= 1;
+
+      m_items.assign(size, T());
+      m_mask = size - 1;
+      m_head.store(0, std::memory_order_relaxed);
+      m_tail.store(0, std::memory_order_relaxed);
+    }
+
+    size_t Capacity(void) const { return m_items.size(); }
+
+    /*!
+     * \brief Append an item (producer only)
+     *
+     * \return false if the buffer is full
+     */
+    bool Push(const T& item)
+    {
+      const size_t tail = m_tail.load(std::memory_order_relaxed);
+      if (tail - m_head.load(std::memory_order_acquire) >= m_items.size())
+        return false;
+
+      m_items[tail & m_mask] = item;
+      m_tail.store(tail + 1, std::memory_order_release);
+
+      return true;
+    }
+
+    /*!
+     * \brief Remove the oldest item (consumer only)
+     *
+     * \return false if the buffer is empty
+     */
+    bool Pop(T& item)
+    {
+      const size_t head = m_head.load(std::memory_order_relaxed);
+      if (head == m_tail.load(std::memory_order_acquire))
+        return false;
+
+      item = m_items[head & m_mask];
+      m_head.store(head + 1, std::memory_order_release);
+
+      return true;
+    }
+
+    bool IsEmpty(void) const
+    {
+      return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+    }
+
+  private:
+    std::vector<T>      m_items;
+    size_t              m_mask;
+    std::atomic<size_t> m_head; // Written by consumer
+    std::atomic<size_t> m_tail; // Written by producer
+  };
+}